@@ -72,6 +72,16 @@ static PyObject* OpenMote_getState(OpenMote* self) {
 #if SCHEDULER_DEBUG_ENABLE
    PyObject* scheduler_dbg;
 #endif
+#if SCHEDULER_PROFILE_ENABLE
+   PyObject* scheduler_prof;
+   PyObject* taskProfileList;
+   PyObject* taskProfile;
+   PyObject* delayHist;
+   PyObject* runHist;
+   taskProfile_item_t* taskProfileRow;
+   uint8_t   i;
+   uint8_t   j;
+#endif
    
    returnVal = PyDict_New();
    
@@ -164,7 +174,11 @@ static PyObject* OpenMote_getState(OpenMote* self) {
    
    // opentimers_vars
    opentimers_vars = PyDict_New();
-   // TODO
+   PyDict_SetItemString(opentimers_vars, "numCompareInterrupts", PyInt_FromLong(self->opentimers_vars.numCompareInterrupts));
+   PyDict_SetItemString(opentimers_vars, "numTimersCoalesced",   PyInt_FromLong(self->opentimers_vars.numTimersCoalesced));
+   PyDict_SetItemString(opentimers_vars, "numTimersInUse",       PyInt_FromLong(self->opentimers_vars.numTimersInUse));
+   PyDict_SetItemString(opentimers_vars, "highWaterMark",        PyInt_FromLong(self->opentimers_vars.highWaterMark));
+   PyDict_SetItemString(opentimers_vars, "numCreateFailures",    PyInt_FromLong(self->opentimers_vars.numCreateFailures));
    PyDict_SetItemString(returnVal, "opentimers_vars", opentimers_vars);
    
    // random_vars
@@ -188,6 +202,33 @@ static PyObject* OpenMote_getState(OpenMote* self) {
    // TODO
    PyDict_SetItemString(returnVal, "scheduler_dbg", scheduler_dbg);
 #endif
+
+   // scheduler_prof
+#if SCHEDULER_PROFILE_ENABLE
+   scheduler_prof = PyDict_New();
+   taskProfileList = PyList_New(0);
+   for (i=0;i<SCHEDULER_PROFILE_NUM_TASKS;i++) {
+      taskProfileRow = &self->scheduler_prof.taskProfileBuf[i];
+      if (taskProfileRow->cb==NULL) {
+         continue;
+      }
+      delayHist = PyList_New(SCHEDULER_PROFILE_NUM_BINS);
+      runHist   = PyList_New(SCHEDULER_PROFILE_NUM_BINS);
+      for (j=0;j<SCHEDULER_PROFILE_NUM_BINS;j++) {
+         PyList_SetItem(delayHist, j, PyInt_FromLong(taskProfileRow->delayHist[j]));
+         PyList_SetItem(runHist,   j, PyInt_FromLong(taskProfileRow->runHist[j]));
+      }
+      taskProfile = PyDict_New();
+      PyDict_SetItemString(taskProfile, "cb",        PyInt_FromLong((intptr_t)taskProfileRow->cb));
+      PyDict_SetItemString(taskProfile, "numRuns",   PyInt_FromLong(taskProfileRow->numRuns));
+      PyDict_SetItemString(taskProfile, "delayHist", delayHist);
+      PyDict_SetItemString(taskProfile, "runHist",   runHist);
+      PyList_Append(taskProfileList, taskProfile);
+   }
+   PyDict_SetItemString(scheduler_prof, "taskProfile", taskProfileList);
+   PyDict_SetItemString(scheduler_prof, "numRunsUnprofiled", PyInt_FromLong(self->scheduler_prof.numRunsUnprofiled));
+   PyDict_SetItemString(returnVal, "scheduler_prof", scheduler_prof);
+#endif
    return returnVal;
 }
 
@@ -26,6 +26,7 @@
 #include "schedule_obj.h"
 #include "icmpv6echo_obj.h"
 #include "icmpv6rpl_obj.h"
+#include "routingtable_obj.h"
 #include "coap_obj.h"
 #include "oscore_obj.h"
 #include "idmanager_obj.h"
@@ -204,6 +205,7 @@ struct OpenMote {
     // l4
     icmpv6echo_vars_t icmpv6echo_vars;
     icmpv6rpl_vars_t icmpv6rpl_vars;
+    routingtable_vars_t routingtable_vars;
     // l3
     monitor_expiration_vars_t monitor_expiration_vars;
     frag_vars_t frag_vars;
@@ -229,6 +231,9 @@ struct OpenMote {
     scheduler_vars_t scheduler_vars;
 #if SCHEDULER_DEBUG_ENABLE
     scheduler_dbg_t scheduler_dbg;
+#endif
+#if SCHEDULER_PROFILE_ENABLE
+    scheduler_prof_t scheduler_prof;
 #endif
     //===== openapps
     //
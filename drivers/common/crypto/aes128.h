@@ -10,8 +10,40 @@ Source: http://is.gd/o9RSPq
 #ifndef OPENWSN_AES128_H
 #define OPENWSN_AES128_H
 
+#include "opendefs.h"
+
+//=========================== typedef =========================================
+
+/**
+\brief Secret key, with its round keys expanded once by aes128_key_init().
+*/
+typedef struct {
+    uint8_t value[16];          // secret key, as taken by the crypto engines
+#if !BOARD_CRYPTOENGINE_ENABLED && BOARD_AES_TTABLE_ENABLED
+    uint32_t expandedKey[44];   // round keys of the T-table implementation, one column per word
+#elif !BOARD_CRYPTOENGINE_ENABLED
+    uint8_t expandedKey[176];   // round keys of the software implementation
+#endif
+} aes128_key_t;
+
 //=========================== prototypes ======================================
 
+/**
+\brief Load a secret key, expanding its round keys for the blocks to come.
+\param[out] key The key to load.
+\param[in] value Buffer containing the secret key (16 octets).
+*/
+void aes128_key_init(aes128_key_t *key, uint8_t *value);
+
+/**
+\brief Basic AES encryption of a single 16-octet block with a loaded key.
+\param[in,out] buffer Single block plaintext. Will be overwritten by ciphertext.
+\param[in] key The key loaded by aes128_key_init().
+
+\returns E_SUCCESS when the encryption was successful.
+*/
+owerror_t aes128_enc_block(uint8_t *buffer, aes128_key_t *key);
+
 /**
 \brief Basic AES encryption of a single 16-octet block.
 \param[in,out] buffer Single block plaintext. Will be overwritten by ciphertext.
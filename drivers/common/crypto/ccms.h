@@ -7,6 +7,8 @@
 #ifndef OPENWSN_CCMS_H
 #define OPENWSN_CCMS_H
 
+#include "aes128.h"
+
 //=========================== prototypes ======================================
 
 /**
@@ -20,7 +22,7 @@
 \param[in] nonce Buffer containing nonce (13 octets).
 \param[in] l CCM parameter L that allows selection of different nonce length. This implementation
    supports l = 2 (i.e. 13 octet long nonce) only.
-\param[in] key Buffer containing the secret key (16 octets).
+\param[in] key The secret key, loaded by aes128_key_init().
 \param[in] len_mac Length of the authentication tag.
 
 \returns E_SUCCESS when the generation was successful, E_FAIL otherwise.
@@ -31,7 +33,7 @@ owerror_t aes128_ccms_enc(uint8_t *a,
                           uint8_t *len_m,
                           uint8_t *nonce,
                           uint8_t l,
-                          uint8_t key[16],
+                          aes128_key_t *key,
                           uint8_t len_mac);
 
 /**
@@ -46,7 +48,7 @@ owerror_t aes128_ccms_enc(uint8_t *a,
 \param[in] nonce Buffer containing nonce (13 octets).
 \param[in] l CCM parameter L that allows selection of different nonce length. This implementation
    supports l = 2 (i.e. 13 octet long nonce) only.
-\param[in] key Buffer containing the secret key (16 octets).
+\param[in] key The secret key, loaded by aes128_key_init().
 \param[in] len_mac Length of the authentication tag.
 
 \returns E_SUCCESS when decryption and verification were successful, E_FAIL otherwise.
@@ -57,7 +59,7 @@ owerror_t aes128_ccms_dec(uint8_t *a,
                           uint8_t *len_m,
                           uint8_t *nonce,
                           uint8_t l,
-                          uint8_t key[16],
+                          aes128_key_t *key,
                           uint8_t len_mac);
 
 #endif /* OPENWSN_CCMS_H */
@@ -34,6 +34,7 @@
 openserial_vars_t openserial_vars;
 
 #define STATUSPRINT_PERIOD 100 // in ms
+#define STATUSPRINT_SLACK   20 // in ms
 
 //=========================== prototypes ======================================
 
@@ -99,8 +100,8 @@ void openserial_init(void) {
     openserial_vars.outputBufIdxW = 0;
     openserial_vars.fBusyFlushing = FALSE;
 
-    openserial_vars.reset_timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_OPENSERIAL);
-    openserial_vars.debugPrint_timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_OPENSERIAL);
+    openserial_vars.reset_timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_OPENSERIAL, COMPONENT_OPENSERIAL);
+    openserial_vars.debugPrint_timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_OPENSERIAL, COMPONENT_OPENSERIAL);
     opentimers_scheduleIn(
             openserial_vars.debugPrint_timerId,
             STATUSPRINT_PERIOD,
@@ -108,6 +109,7 @@ void openserial_init(void) {
             TIMER_PERIODIC,
             openserial_debugPrint_timer_cb
     );
+    opentimers_setSlack(openserial_vars.debugPrint_timerId, STATUSPRINT_SLACK, TIME_MS);
 
     // UART
     uart_setCallbacks(isr_openserial_tx, isr_openserial_rx);
@@ -398,6 +400,24 @@ void task_openserial_debugPrint(void) {
             if (debugPrint_msf() == TRUE) {
                 break;
             }
+#if SCHEDULER_PROFILE_ENABLE
+        case STATUS_SCHEDULERPROFILE:
+            if (debugPrint_schedulerProfile() == TRUE) {
+                break;
+            }
+#endif
+#if OPENTIMERS_DEBUG_ENABLE
+        case STATUS_OPENTIMERS:
+            if (debugPrint_opentimers() == TRUE) {
+                break;
+            }
+#endif
+#if OPENQUEUE_DEBUG_ENABLE
+        case STATUS_QUEUECLASSES:
+            if (debugPrint_queueClasses() == TRUE) {
+                break;
+            }
+#endif
         default:
             debugPrintCounter = 0;
     }
@@ -559,6 +579,31 @@ bool debugPrint_outBufferIndexes(void) {
     return TRUE;
 }
 
+#if SCHEDULER_PROFILE_ENABLE
+/**
+\brief Print one row of the scheduler's task profile table.
+
+\returns TRUE if this function printed something, FALSE otherwise.
+*/
+bool debugPrint_schedulerProfile(void) {
+    debugTaskProfileEntry_t temp;
+
+    temp.row = scheduler_getNextTaskProfile(&temp.taskProfile);
+    if (temp.taskProfile.cb == NULL) {
+        // nothing profiled in this row yet
+        return FALSE;
+    }
+
+    openserial_printStatus(
+            STATUS_SCHEDULERPROFILE,
+            (uint8_t * ) & temp,
+            sizeof(debugTaskProfileEntry_t)
+    );
+
+    return TRUE;
+}
+#endif
+
 //=========================== private =========================================
 
 //===== printing
@@ -174,6 +174,10 @@ void openserial_inhibitStop(void);
 // debugprint
 bool debugPrint_outBufferIndexes(void);
 
+#if SCHEDULER_PROFILE_ENABLE
+bool debugPrint_schedulerProfile(void);
+#endif
+
 // interrupt handlers
 uint8_t isr_openserial_rx(void);
 
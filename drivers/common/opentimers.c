@@ -14,6 +14,9 @@ at most MAX_NUM_TIMERS timers.
 #include "debugpins.h"
 // kernel module is required
 #include "scheduler.h"
+#if OPENTIMERS_DEBUG_ENABLE
+#include "openserial.h"
+#endif
 
 //=========================== define ==========================================
 
@@ -24,6 +27,14 @@ opentimers_vars_t opentimers_vars;
 //=========================== prototypes ======================================
 
 void  opentimers_timer_callback(void);
+void  opentimers_timerCreated(opentimers_id_t id, uint8_t owner);
+bool  opentimers_isDue(opentimers_id_t id);
+void  opentimers_rearmPeriodic(opentimers_id_t id);
+#if OPENTIMERS_SORTED_LIST_ENABLE
+void  opentimers_updateMaxSlack(void);
+void  opentimers_linkTimer(opentimers_id_t id);
+void  opentimers_unlinkTimer(opentimers_id_t id);
+#endif
 
 //=========================== public ==========================================
 
@@ -36,6 +47,9 @@ void opentimers_init(void){
 
     // initialize local variables
     memset(&opentimers_vars,0,sizeof(opentimers_vars_t));
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    opentimers_vars.listHead = OPENTIMERS_LIST_END;
+#endif
 
     // set callback for sctimer module
     sctimer_set_callback(opentimers_timer_callback);
@@ -45,11 +59,12 @@ void opentimers_init(void){
 \brief create a timer by assigning an entry from timer buffer.
 
 create a timer with given id or assigning one if it's general purpose timer.
-task_prio gives a priority when opentimer push a task.
+task_prio gives a priority when opentimer push a task. owner is the component
+creating the timer, it is only used for debugging.
 
 \returns the id of the timer will be returned
  */
-opentimers_id_t opentimers_create(uint8_t timer_id, uint8_t task_prio){
+opentimers_id_t opentimers_create(uint8_t timer_id, uint8_t task_prio, uint8_t owner){
     uint8_t id;
 
     INTERRUPT_DECLARATION();
@@ -60,6 +75,7 @@ opentimers_id_t opentimers_create(uint8_t timer_id, uint8_t task_prio){
             opentimers_vars.timersBuf[timer_id].isUsed   = TRUE;
             // the TSCH timer and inhibit timer won't push a task,
             // hence task_prio is not used
+            opentimers_timerCreated(timer_id, owner);
             ENABLE_INTERRUPTS();
             return timer_id;
         }
@@ -70,12 +86,17 @@ opentimers_id_t opentimers_create(uint8_t timer_id, uint8_t task_prio){
             if (opentimers_vars.timersBuf[id].isUsed  == FALSE){
                 opentimers_vars.timersBuf[id].isUsed   = TRUE;
                 opentimers_vars.timersBuf[id].timer_task_prio = task_prio;
+                opentimers_timerCreated(id, owner);
                 ENABLE_INTERRUPTS();
                 return id;
             }
         }
     }
 
+    if (opentimers_vars.numCreateFailures < 0xff){
+        opentimers_vars.numCreateFailures++;
+    }
+
     ENABLE_INTERRUPTS();
 
     // there is no available buffer for this timer
@@ -100,9 +121,11 @@ void opentimers_scheduleIn(opentimers_id_t    id,
                            timer_type_t       timer_type,
                            opentimers_cbt     cb){
     uint8_t  i;
+#if OPENTIMERS_SORTED_LIST_ENABLE==0
     uint8_t  idToSchedule;
     PORT_TIMER_WIDTH timerGap;
     PORT_TIMER_WIDTH tempTimerGap;
+#endif
 
     INTERRUPT_DECLARATION();
     // 1. make sure the timer exist
@@ -118,6 +141,13 @@ void opentimers_scheduleIn(opentimers_id_t    id,
 
     DISABLE_INTERRUPTS();
 
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    // the timer is re-inserted in the sorted list once its new compare value is known
+    if (opentimers_vars.timersBuf[id].isrunning){
+        opentimers_unlinkTimer(id);
+    }
+#endif
+
     opentimers_vars.timersBuf[id].timerType = timer_type;
 
     // 2. updat the timer content
@@ -140,11 +170,19 @@ void opentimers_scheduleIn(opentimers_id_t    id,
 
     opentimers_vars.timersBuf[id].isrunning           = TRUE;
     opentimers_vars.timersBuf[id].callback            = cb;
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    opentimers_linkTimer(id);
+#endif
 
     // 3. find the next timer to fire
 
     // only execute update the currentCompareValue if I am not inside of ISR or the ISR itself will do this.
     if (opentimers_vars.insideISR==FALSE){
+#if OPENTIMERS_SORTED_LIST_ENABLE
+        // the head of the sorted list is the next timer to fire
+        opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[opentimers_vars.listHead].currentCompareValue;
+        sctimer_setCompare(opentimers_vars.currentCompareValue);
+#else
         i = 0;
         while (opentimers_vars.timersBuf[i].isrunning==FALSE){
             i++;
@@ -165,6 +203,7 @@ void opentimers_scheduleIn(opentimers_id_t    id,
         // if I got here, assign the next to be fired timer to given timer
         opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[idToSchedule].currentCompareValue;
         sctimer_setCompare(opentimers_vars.currentCompareValue);
+#endif
     }
     opentimers_vars.running        = TRUE;
 
@@ -190,9 +229,11 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
                                  time_type_t        uint_type,
                                  opentimers_cbt     cb){
     uint8_t  i;
+#if OPENTIMERS_SORTED_LIST_ENABLE==0
     uint8_t idToSchedule;
     PORT_TIMER_WIDTH timerGap;
     PORT_TIMER_WIDTH tempTimerGap;
+#endif
 
     INTERRUPT_DECLARATION();
 
@@ -209,6 +250,13 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
 
     DISABLE_INTERRUPTS();
 
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    // the timer is re-inserted in the sorted list once its new compare value is known
+    if (opentimers_vars.timersBuf[id].isrunning){
+        opentimers_unlinkTimer(id);
+    }
+#endif
+
     // absolute scheduling is for one shot timer
     opentimers_vars.timersBuf[id].timerType = TIMER_ONESHOT;
 
@@ -232,11 +280,19 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
 
     opentimers_vars.timersBuf[id].isrunning = TRUE;
     opentimers_vars.timersBuf[id].callback  = cb;
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    opentimers_linkTimer(id);
+#endif
 
     // 3. find the next timer to fire
 
     // only execute update the currentCompareValue if I am not inside of ISR or the ISR itself will do this.
     if (opentimers_vars.insideISR==FALSE){
+#if OPENTIMERS_SORTED_LIST_ENABLE
+        // the head of the sorted list is the next timer to fire
+        opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[opentimers_vars.listHead].currentCompareValue;
+        sctimer_setCompare(opentimers_vars.currentCompareValue);
+#else
         i = 0;
         while (opentimers_vars.timersBuf[i].isrunning==FALSE){
             i++;
@@ -257,6 +313,7 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
         // if I got here, assign the next to be fired timer to given timer
         opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[idToSchedule].currentCompareValue;
         sctimer_setCompare(opentimers_vars.currentCompareValue);
+#endif
     }
     opentimers_vars.running = TRUE;
 
@@ -293,6 +350,11 @@ void opentimers_cancel(opentimers_id_t id){
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    if (opentimers_vars.timersBuf[id].isrunning){
+        opentimers_unlinkTimer(id);
+    }
+#endif
     opentimers_vars.timersBuf[id].isrunning = FALSE;
     opentimers_vars.timersBuf[id].callback  = NULL;
 
@@ -309,8 +371,24 @@ Reset the whole entry of given timer including the id.
 \returns False if the given can't be found or return Success
  */
 bool opentimers_destroy(opentimers_id_t id){
+    INTERRUPT_DECLARATION();
+
     if (id<MAX_NUM_TIMERS){
+        DISABLE_INTERRUPTS();
+#if OPENTIMERS_SORTED_LIST_ENABLE
+        if (opentimers_vars.timersBuf[id].isrunning){
+            opentimers_unlinkTimer(id);
+        }
+#endif
+        if (opentimers_vars.timersBuf[id].isUsed){
+            opentimers_vars.numTimersInUse--;
+        }
         memset(&opentimers_vars.timersBuf[id],0,sizeof(opentimers_t));
+#if OPENTIMERS_SORTED_LIST_ENABLE
+        // the slack of this timer may have been the largest one
+        opentimers_updateMaxSlack();
+#endif
+        ENABLE_INTERRUPTS();
         return TRUE;
     } else {
         return FALSE;
@@ -343,6 +421,253 @@ PORT_TIMER_WIDTH opentimers_getCurrentCompareValue(void){
 bool opentimers_isRunning(opentimers_id_t id){
     return opentimers_vars.timersBuf[id].isrunning;
 }
+
+/**
+\brief set the slack of a general purpose timer.
+
+A timer with slack may fire up to slack before it expires, when the compare
+interrupt of another timer happens within that window. Batching the timers
+this way saves a wakeup from sleep. The slack is kept across reschedules and
+only applies to the last wrap of a long timer. It is reset when the timer is
+destroyed.
+
+\param[in] id the timer id
+\param[in] slack how early the timer may fire
+\param[in] uint_type indicates the unit type of the slack: ticks or ms
+ */
+void opentimers_setSlack(opentimers_id_t id, uint32_t slack, time_type_t uint_type){
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    switch (uint_type){
+    case TIME_MS:
+        opentimers_vars.timersBuf[id].slack = slack*PORT_TICS_PER_MS;
+        break;
+    case TIME_TICS:
+        opentimers_vars.timersBuf[id].slack = slack;
+        break;
+    }
+
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    opentimers_updateMaxSlack();
+#endif
+
+    ENABLE_INTERRUPTS();
+}
+
+/**
+\brief get the number of compare interrupts handled since boot.
+
+Each compare interrupt wakes the mote up, dividing this counter by the uptime
+gives the wakeup rate caused by timers.
+
+\returns the numCompareInterrupts variable.
+ */
+uint32_t opentimers_getNumCompareInterrupts(void){
+    return opentimers_vars.numCompareInterrupts;
+}
+
+/**
+\brief get the number of timers fired early thanks to their slack.
+
+\returns the numTimersCoalesced variable.
+ */
+uint32_t opentimers_getNumTimersCoalesced(void){
+    return opentimers_vars.numTimersCoalesced;
+}
+
+/**
+\brief get the maximum number of timers in use at the same time since boot.
+
+\returns the highWaterMark variable.
+ */
+uint8_t opentimers_getHighWaterMark(void){
+    return opentimers_vars.highWaterMark;
+}
+
+#if OPENTIMERS_DEBUG_ENABLE
+/**
+\brief print the next timer in use over serial, round-robin.
+
+\returns FALSE if no timer is in use.
+ */
+bool debugPrint_opentimers(void){
+    debugOpentimersEntry_t temp;
+    uint8_t                i;
+    opentimers_id_t        id;
+
+    for (i=0;i<MAX_NUM_TIMERS;i++){
+        id = opentimers_vars.debugPrintRow;
+        opentimers_vars.debugPrintRow = (opentimers_vars.debugPrintRow+1)%MAX_NUM_TIMERS;
+        if (opentimers_vars.timersBuf[id].isUsed){
+            temp.row               = id;
+            temp.owner             = opentimers_vars.timersBuf[id].owner;
+            temp.timerType         = (uint8_t)opentimers_vars.timersBuf[id].timerType;
+            temp.isrunning         = opentimers_vars.timersBuf[id].isrunning;
+            temp.duration          = opentimers_vars.timersBuf[id].duration;
+            temp.numTimersInUse    = opentimers_vars.numTimersInUse;
+            temp.highWaterMark     = opentimers_vars.highWaterMark;
+            temp.numCreateFailures = opentimers_vars.numCreateFailures;
+            openserial_printStatus(
+                    STATUS_OPENTIMERS,
+                    (uint8_t * ) & temp,
+                    sizeof(debugOpentimersEntry_t)
+            );
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+#endif
+
+//=========================== private =========================================
+
+/**
+\brief record the owner of a timer entry just taken from the timer buffer.
+
+Call with interrupts disabled.
+
+\param[in] id the timer id
+\param[in] owner the component which created the timer
+ */
+void opentimers_timerCreated(opentimers_id_t id, uint8_t owner){
+    opentimers_vars.timersBuf[id].owner = owner;
+    opentimers_vars.numTimersInUse++;
+    if (opentimers_vars.numTimersInUse > opentimers_vars.highWaterMark){
+        opentimers_vars.highWaterMark = opentimers_vars.numTimersInUse;
+    }
+}
+
+/**
+\brief is the given timer due at the current compare value?
+
+A timer is due when its compare value is the current one, or when it lies
+within the timer's slack after the current one on the last wrap.
+
+\param[in] id the timer id
+ */
+bool opentimers_isDue(opentimers_id_t id){
+    PORT_TIMER_WIDTH slack;
+
+    if (opentimers_vars.timersBuf[id].wraps_remaining==0){
+        slack = opentimers_vars.timersBuf[id].slack;
+    } else {
+        slack = 0;
+    }
+    return (PORT_TIMER_WIDTH)(opentimers_vars.timersBuf[id].currentCompareValue - opentimers_vars.currentCompareValue) <= slack;
+}
+
+/**
+\brief re-arm a periodic timer which just expired, one period after its deadline.
+
+The period runs from the deadline the timer was due at, not from the time it
+fired, so a timer fired early within its slack does not drift.
+
+Call with interrupts disabled, the timer being out of the sorted timer list.
+
+\param[in] id the timer id
+ */
+void opentimers_rearmPeriodic(opentimers_id_t id){
+    PORT_TIMER_WIDTH deadline;
+
+    deadline = opentimers_vars.timersBuf[id].currentCompareValue;
+    opentimers_vars.timersBuf[id].wraps_remaining  = (uint32_t)(opentimers_vars.timersBuf[id].duration)/MAX_TICKS_IN_SINGLE_CLOCK;
+    if (opentimers_vars.timersBuf[id].wraps_remaining==0){
+        opentimers_vars.timersBuf[id].currentCompareValue = opentimers_vars.timersBuf[id].duration+deadline;
+    } else {
+        opentimers_vars.timersBuf[id].currentCompareValue = MAX_TICKS_IN_SINGLE_CLOCK+deadline;
+    }
+    opentimers_vars.timersBuf[id].isrunning           = TRUE;
+#if OPENTIMERS_SORTED_LIST_ENABLE
+    opentimers_linkTimer(id);
+#endif
+}
+
+#if OPENTIMERS_SORTED_LIST_ENABLE
+/**
+\brief recompute the largest slack of all timers.
+
+Call with interrupts disabled.
+ */
+void opentimers_updateMaxSlack(void){
+    uint8_t i;
+
+    opentimers_vars.maxSlack = 0;
+    for (i=0;i<MAX_NUM_TIMERS;i++){
+        if (opentimers_vars.timersBuf[i].slack > opentimers_vars.maxSlack){
+            opentimers_vars.maxSlack = opentimers_vars.timersBuf[i].slack;
+        }
+    }
+}
+
+/**
+\brief insert a running timer in the sorted timer list.
+
+Timers are ordered by the distance of their compare value from lastCompareValue,
+which is how the timer to fire next is chosen. Timers expiring at the same time
+are ordered by id, so they fire in the same order as with a buffer scan.
+
+Call with interrupts disabled.
+
+\param[in] id the timer id
+ */
+void opentimers_linkTimer(opentimers_id_t id){
+    opentimers_id_t  prev;
+    opentimers_id_t  next;
+    PORT_TIMER_WIDTH timerGap;
+    PORT_TIMER_WIDTH tempTimerGap;
+
+    timerGap = opentimers_vars.timersBuf[id].currentCompareValue-opentimers_vars.lastCompareValue;
+
+    prev = OPENTIMERS_LIST_END;
+    next = opentimers_vars.listHead;
+    while (next!=OPENTIMERS_LIST_END){
+        tempTimerGap = opentimers_vars.timersBuf[next].currentCompareValue-opentimers_vars.lastCompareValue;
+        if (tempTimerGap > timerGap || (tempTimerGap == timerGap && next > id)){
+            break;
+        }
+        prev = next;
+        next = opentimers_vars.timersBuf[next].next;
+    }
+
+    opentimers_vars.timersBuf[id].prev = prev;
+    opentimers_vars.timersBuf[id].next = next;
+    if (prev==OPENTIMERS_LIST_END){
+        opentimers_vars.listHead = id;
+    } else {
+        opentimers_vars.timersBuf[prev].next = id;
+    }
+    if (next!=OPENTIMERS_LIST_END){
+        opentimers_vars.timersBuf[next].prev = id;
+    }
+}
+
+/**
+\brief remove a timer from the sorted timer list.
+
+Call with interrupts disabled, only for a timer which is in the list.
+
+\param[in] id the timer id
+ */
+void opentimers_unlinkTimer(opentimers_id_t id){
+    opentimers_id_t prev;
+    opentimers_id_t next;
+
+    prev = opentimers_vars.timersBuf[id].prev;
+    next = opentimers_vars.timersBuf[id].next;
+    if (prev==OPENTIMERS_LIST_END){
+        opentimers_vars.listHead = next;
+    } else {
+        opentimers_vars.timersBuf[prev].next = next;
+    }
+    if (next!=OPENTIMERS_LIST_END){
+        opentimers_vars.timersBuf[next].prev = prev;
+    }
+    opentimers_vars.timersBuf[id].prev = OPENTIMERS_LIST_END;
+    opentimers_vars.timersBuf[id].next = OPENTIMERS_LIST_END;
+}
+#endif
+
 // ========================== task ============================================
 
 // ========================== callback ========================================
@@ -354,12 +679,125 @@ This function is called when sctimer interrupt happens. The function looks the
 whole timer buffer and find out the correct timer responding to the interrupt
 and call the callback recorded for that timer.
  */
+#if OPENTIMERS_SORTED_LIST_ENABLE
+void opentimers_timer_callback(void){
+    uint8_t          i;
+    uint8_t          numExpired;
+    opentimers_id_t  id;
+    opentimers_id_t  next;
+    opentimers_id_t  expired[MAX_NUM_TIMERS];
+
+    opentimers_vars.numCompareInterrupts++;
+
+    if (
+        opentimers_vars.timersBuf[TIMER_INHIBIT].isrunning==TRUE &&
+        opentimers_vars.currentCompareValue == opentimers_vars.timersBuf[TIMER_INHIBIT].currentCompareValue
+    ){
+        opentimers_unlinkTimer(TIMER_INHIBIT);
+        opentimers_vars.timersBuf[TIMER_INHIBIT].isrunning  = FALSE;
+        opentimers_vars.timersBuf[TIMER_INHIBIT].callback(TIMER_INHIBIT);
+        // the next timer selection will be done after SPLITE_TIMER_DURATION ticks
+        sctimer_setCompare(sctimer_readCounter()+SPLITE_TIMER_DURATION);
+        return;
+    }
+
+    // no running timer expires before currentCompareValue, moving the reference keeps the list sorted
+    opentimers_vars.lastCompareValue = opentimers_vars.currentCompareValue;
+
+    if (opentimers_vars.timersBuf[TIMER_INHIBIT].currentCompareValue == opentimers_vars.currentCompareValue){
+        // this is the timer interrupt right after inhibit timer, pre call the non-tsch, non-inhibit timer interrupt here to avoid interrupt during receiving serial bytes
+        id = opentimers_vars.listHead;
+        while (
+            id!=OPENTIMERS_LIST_END &&
+            opentimers_vars.timersBuf[id].currentCompareValue - opentimers_vars.currentCompareValue < PRE_CALL_TIMER_WINDOW
+        ){
+            next = opentimers_vars.timersBuf[id].next;
+            if (id!=TIMER_TSCH && id!=TIMER_INHIBIT){
+                opentimers_unlinkTimer(id);
+                opentimers_vars.timersBuf[id].currentCompareValue = opentimers_vars.currentCompareValue;
+                opentimers_linkTimer(id);
+            }
+            id = next;
+        }
+    }
+
+    // the due timers are within maxSlack of the head of the list, collect them before any callback reschedules a timer
+    numExpired = 0;
+    id = opentimers_vars.listHead;
+    while (
+        id!=OPENTIMERS_LIST_END &&
+        (PORT_TIMER_WIDTH)(opentimers_vars.timersBuf[id].currentCompareValue - opentimers_vars.currentCompareValue) <= opentimers_vars.maxSlack
+    ){
+        if (opentimers_isDue(id)){
+            expired[numExpired++] = id;
+        }
+        id = opentimers_vars.timersBuf[id].next;
+    }
+
+    for (i=0;i<numExpired;i++){
+        id = expired[i];
+        if (opentimers_vars.timersBuf[id].isrunning==FALSE || opentimers_isDue(id)==FALSE){
+            // the timer was cancelled or rescheduled by a callback
+            continue;
+        }
+        opentimers_unlinkTimer(id);
+        if (opentimers_vars.timersBuf[id].currentCompareValue != opentimers_vars.currentCompareValue){
+            opentimers_vars.numTimersCoalesced++;
+        }
+
+        // this timer expired, mark as expired
+        opentimers_vars.timersBuf[id].lastCompareValue    = opentimers_vars.timersBuf[id].currentCompareValue;
+        if (id==TIMER_TSCH){
+            opentimers_vars.insideISR = TRUE;
+            opentimers_vars.timersBuf[id].isrunning  = FALSE;
+            opentimers_vars.timersBuf[id].callback(id);
+            opentimers_vars.insideISR = FALSE;
+        } else {
+            if (opentimers_vars.timersBuf[id].wraps_remaining==0){
+                opentimers_vars.timersBuf[id].isrunning = FALSE;
+                scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[id].callback),(task_prio_t)opentimers_vars.timersBuf[id].timer_task_prio);
+                if (opentimers_vars.timersBuf[id].timerType==TIMER_PERIODIC){
+                    opentimers_rearmPeriodic(id);
+                }
+            } else {
+                opentimers_vars.timersBuf[id].wraps_remaining--;
+                if (opentimers_vars.timersBuf[id].wraps_remaining == 0){
+                    opentimers_vars.timersBuf[id].currentCompareValue = (opentimers_vars.timersBuf[id].duration+opentimers_vars.timersBuf[id].lastCompareValue) & MAX_TICKS_IN_SINGLE_CLOCK;
+                    if (opentimers_vars.timersBuf[id].currentCompareValue - opentimers_vars.currentCompareValue < PRE_CALL_TIMER_WINDOW){
+                        // pre-call the timer here if it will be fired within PRE_CALL_TIMER_WINDOW, when wraps_remaining decrease to 0
+                        opentimers_vars.timersBuf[id].isrunning  = FALSE;
+                        scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[id].callback),(task_prio_t)opentimers_vars.timersBuf[id].timer_task_prio);
+                        if (opentimers_vars.timersBuf[id].timerType==TIMER_PERIODIC){
+                            opentimers_rearmPeriodic(id);
+                        }
+                    } else {
+                        opentimers_linkTimer(id);
+                    }
+                } else {
+                    opentimers_vars.timersBuf[id].currentCompareValue = opentimers_vars.timersBuf[id].lastCompareValue + MAX_TICKS_IN_SINGLE_CLOCK;
+                    opentimers_linkTimer(id);
+                }
+            }
+        }
+    }
+
+    // the head of the list is the next timer to be fired
+    if (opentimers_vars.listHead!=OPENTIMERS_LIST_END){
+        opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[opentimers_vars.listHead].currentCompareValue;
+        sctimer_setCompare(opentimers_vars.currentCompareValue);
+    } else {
+        opentimers_vars.running        = FALSE;
+    }
+}
+#else
 void opentimers_timer_callback(void){
     uint8_t i;
     uint8_t idToSchedule;
     PORT_TIMER_WIDTH timerGap;
     PORT_TIMER_WIDTH tempTimerGap;
 
+    opentimers_vars.numCompareInterrupts++;
+
     if (
         opentimers_vars.timersBuf[TIMER_INHIBIT].isrunning==TRUE &&
         opentimers_vars.currentCompareValue == opentimers_vars.timersBuf[TIMER_INHIBIT].currentCompareValue
@@ -382,7 +820,10 @@ void opentimers_timer_callback(void){
         }
         for (i=0;i<MAX_NUM_TIMERS;i++){
             if (opentimers_vars.timersBuf[i].isrunning==TRUE){
-                if (opentimers_vars.currentCompareValue == opentimers_vars.timersBuf[i].currentCompareValue){
+                if (opentimers_isDue(i)){
+                    if (opentimers_vars.currentCompareValue != opentimers_vars.timersBuf[i].currentCompareValue){
+                        opentimers_vars.numTimersCoalesced++;
+                    }
                     // this timer expired, mark as expired
                     opentimers_vars.timersBuf[i].lastCompareValue    = opentimers_vars.timersBuf[i].currentCompareValue;
                     if (i==TIMER_TSCH){
@@ -395,15 +836,7 @@ void opentimers_timer_callback(void){
                             opentimers_vars.timersBuf[i].isrunning = FALSE;
                             scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[i].callback),(task_prio_t)opentimers_vars.timersBuf[i].timer_task_prio);
                             if (opentimers_vars.timersBuf[i].timerType==TIMER_PERIODIC){
-                                opentimers_vars.insideISR = TRUE;
-                                opentimers_scheduleIn(
-                                    i,
-                                    opentimers_vars.timersBuf[i].duration,
-                                    TIME_TICS,
-                                    TIMER_PERIODIC,
-                                    opentimers_vars.timersBuf[i].callback
-                                );
-                                opentimers_vars.insideISR = FALSE;
+                                opentimers_rearmPeriodic(i);
                             }
                         } else {
                             opentimers_vars.timersBuf[i].wraps_remaining--;
@@ -414,15 +847,7 @@ void opentimers_timer_callback(void){
                                     opentimers_vars.timersBuf[i].isrunning  = FALSE;
                                     scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[i].callback),(task_prio_t)opentimers_vars.timersBuf[i].timer_task_prio);
                                     if (opentimers_vars.timersBuf[i].timerType==TIMER_PERIODIC){
-                                        opentimers_vars.insideISR = TRUE;
-                                        opentimers_scheduleIn(
-                                            i,
-                                            opentimers_vars.timersBuf[i].duration,
-                                            TIME_TICS,
-                                            TIMER_PERIODIC,
-                                            opentimers_vars.timersBuf[i].callback
-                                        );
-                                        opentimers_vars.insideISR = FALSE;
+                                        opentimers_rearmPeriodic(i);
                                     }
                                 }
                             } else {
@@ -460,4 +885,5 @@ void opentimers_timer_callback(void){
     } else {
         opentimers_vars.running        = FALSE;
     }
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
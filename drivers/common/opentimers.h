@@ -9,6 +9,9 @@
 
 #include "opendefs.h"
 #include "board_info.h"
+#if OPENWSN_CSENSORS_C
+#include "sensors.h"
+#endif
 
 /**
 \addtogroup drivers
@@ -19,8 +22,34 @@
 
 //=========================== define ==========================================
 
+// timers created by the stack: TIMER_INHIBIT and TIMER_TSCH, openserial (2), sixtop (3), msf (2), icmpv6rpl (2)
+#define OPENTIMERS_NUM_STACK_TIMERS  11
+
+// frag creates one timer per reassembled big packet and one per virtual reassembly buffer (NUM_OF_CONCURRENT_TIMERS)
+#if OPENWSN_6LO_FRAGMENTATION_C
+#define OPENTIMERS_NUM_FRAG_TIMERS   (MAX_NUM_BIGPKTS + NUM_OF_VRBS)
+#else
+#define OPENTIMERS_NUM_FRAG_TIMERS   0
+#endif
+
+// csensors creates one timer per sensor
+#if OPENWSN_CSENSORS_C
+#define OPENTIMERS_NUM_CSENSORS_TIMERS NUMSENSORS
+#else
+#define OPENTIMERS_NUM_CSENSORS_TIMERS 0
+#endif
+
+#define OPENTIMERS_NUM_APP_TIMERS    (OPENWSN_CEXAMPLE_C + OPENWSN_CINFRARED_C + OPENWSN_CJOIN_C + OPENWSN_CSTORM_C + \
+                                      OPENWSN_UEXPIRATION_C + OPENWSN_UINJECT_C + OPENTIMERS_NUM_CSENSORS_TIMERS)
+
 /// Maximum number of timers that can run concurrently
-#define MAX_NUM_TIMERS             15
+#ifndef MAX_NUM_TIMERS
+#define MAX_NUM_TIMERS             (OPENTIMERS_NUM_STACK_TIMERS + OPENTIMERS_NUM_FRAG_TIMERS + \
+                                    OPENTIMERS_NUM_APP_TIMERS + OPENTIMERS_NUM_SPARE_TIMERS)
+#endif
+#if MAX_NUM_TIMERS >= 255
+#error "MAX_NUM_TIMERS must be smaller than 255, timer ids are 8-bit and 255 marks an invalid id."
+#endif
 #define MAX_TICKS_IN_SINGLE_CLOCK  (uint32_t)(((PORT_TIMER_WIDTH)0xFFFFFFFF)>>1)
 #define ERROR_NO_AVAILABLE_ENTRIES 255
 #define MAX_DURATION_ISR           33 // 33@32768Hz = 1ms
@@ -32,6 +61,8 @@
 
 #define TIMER_NUMBER_NON_GENERAL   2
 
+#define OPENTIMERS_LIST_END        0xff // marks the end of the sorted timer list
+
 #define SPLITE_TIMER_DURATION     (500/PORT_US_PER_TICK) // in 500us
 #define PRE_CALL_TIMER_WINDOW     PORT_TsSlotDuration
 
@@ -60,8 +91,29 @@ typedef struct {
    bool                 hasExpired;         // in case there are more than one interrupt occur at same time
    opentimers_cbt       callback;           // function to call when elapses
    uint8_t              timer_task_prio;    // when opentimer push a task, use timer_task_prio to mark the priority
+   PORT_TIMER_WIDTH     slack;              // the timer may fire up to slack ticks early to share a compare interrupt
+   uint8_t              owner;              // the component which created this timer
+#if OPENTIMERS_SORTED_LIST_ENABLE
+   opentimers_id_t      next;               // next running timer in the sorted list
+   opentimers_id_t      prev;               // previous running timer in the sorted list
+#endif
 } opentimers_t;
 
+#if OPENTIMERS_DEBUG_ENABLE
+BEGIN_PACK
+typedef struct {
+   uint8_t              row;                // the timer id
+   uint8_t              owner;              // the component which created this timer
+   uint8_t              timerType;          // the timer type
+   bool                 isrunning;          // is running?
+   uint32_t             duration;           // the duration that set by timer, in ticks
+   uint8_t              numTimersInUse;     // number of timers created and not destroyed
+   uint8_t              highWaterMark;      // maximum of numTimersInUse since boot
+   uint8_t              numCreateFailures;  // number of times opentimers_create found no free entry
+} debugOpentimersEntry_t;
+END_PACK
+#endif
+
 //=========================== module variables ================================
 
 typedef struct {
@@ -70,12 +122,24 @@ typedef struct {
    PORT_TIMER_WIDTH     currentCompareValue;// current timeout, in ticks
    PORT_TIMER_WIDTH     lastCompareValue;   // last timeout, in ticks. This is the reference time to calculate the next to be expired timer.
    bool                 insideISR;          // whether the function of opentimer is called inside of ISR or not
+   uint32_t             numCompareInterrupts;// number of compare interrupts handled since boot
+   uint32_t             numTimersCoalesced; // number of timers fired early, in the compare interrupt of another timer
+   uint8_t              numTimersInUse;     // number of timers created and not destroyed
+   uint8_t              highWaterMark;      // maximum of numTimersInUse since boot
+   uint8_t              numCreateFailures;  // number of times opentimers_create found no free entry, saturating
+#if OPENTIMERS_DEBUG_ENABLE
+   opentimers_id_t      debugPrintRow;      // next timer to print in the STATUS_OPENTIMERS frame
+#endif
+#if OPENTIMERS_SORTED_LIST_ENABLE
+   opentimers_id_t      listHead;           // running timer to fire first, OPENTIMERS_LIST_END if none
+   PORT_TIMER_WIDTH     maxSlack;           // largest slack of all timers, bounds the search for due timers
+#endif
 } opentimers_vars_t;
 
 //=========================== prototypes ======================================
 
 void             opentimers_init(void);
-opentimers_id_t  opentimers_create(uint8_t timer_id, uint8_t task_priority);
+opentimers_id_t  opentimers_create(uint8_t timer_id, uint8_t task_priority, uint8_t owner);
 void             opentimers_scheduleIn(opentimers_id_t      id,
                                        uint32_t            duration,
                                        time_type_t         uint_type,
@@ -94,6 +158,15 @@ bool             opentimers_destroy(opentimers_id_t id);
 PORT_TIMER_WIDTH opentimers_getValue(void);
 PORT_TIMER_WIDTH opentimers_getCurrentCompareValue(void);
 bool             opentimers_isRunning(opentimers_id_t id);
+void             opentimers_setSlack(opentimers_id_t id,
+                                     uint32_t        slack,
+                                     time_type_t     uint_type);
+uint32_t         opentimers_getNumCompareInterrupts(void);
+uint32_t         opentimers_getNumTimersCoalesced(void);
+uint8_t          opentimers_getHighWaterMark(void);
+#if OPENTIMERS_DEBUG_ENABLE
+bool             debugPrint_opentimers(void);
+#endif
 /**
 \}
 \}
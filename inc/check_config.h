@@ -107,7 +107,8 @@
 
 #if !OPENWSN_6LO_FRAGMENTATION_C && (\
     MAX_PKTSIZE_SUPPORTED || \
-    MAX_NUM_BIGPKTS)
+    MAX_NUM_BIGPKTS || \
+    NUM_OF_VRBS)
 #error "6LoWPAN fragmentation options specified, but 6LoWPAN fragmentation is not included in the build."
 #endif
 
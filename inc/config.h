@@ -245,6 +245,7 @@
  *  - MAX_PKTSIZE_SUPPORTED: defines the maximum IPV6 packet size (header + payload) the mote supports. Default
  *  value is 1320. This corresponds to a 40-byte IPv6 header + the minimal IPv6 MTU of 1280 bytes.
  *  - MAX_NUM_BIGPKTS: defines how many static buffer space will be allocated for processing large packets.
+ *  - NUM_OF_VRBS: defines how many virtual reassembly buffers track the fragments forwarded without reassembly.
  *
  */
 #ifndef OPENWSN_6LO_FRAGMENTATION_C
@@ -258,6 +259,9 @@
 #ifndef MAX_NUM_BIGPKTS
 #define MAX_NUM_BIGPKTS         2
 #endif
+#ifndef NUM_OF_VRBS
+#define NUM_OF_VRBS             2
+#endif
 #endif
 
 /**
@@ -353,15 +357,104 @@
 #define IEEE802154E_SINGLE_CHANNEL      0
 #endif
 
+/**
+ * \def IEEE802154E_SLOT_SKIP
+ *
+ * Enables slot skipping at boot (it can still be toggled from the serial port).
+ * A non-root node then programs a single timer across the idle slots up to its next active slot instead of waking up
+ * every slot.
+ *
+ */
+#ifndef IEEE802154E_SLOT_SKIP
+#define IEEE802154E_SLOT_SKIP      (0)
+#endif
+
 /**
  * \def PACKETQUEUE_LENGTH
  *
  * Specifies the size of the packet queue. Large queue sizes are required to support fragmentation but significantly
- * increase RAM usage.
+ * increase RAM usage. Each entry takes 264 bytes on a 32-bit target, the 6P response context lives in a separate pool.
+ * A queue shorter than the OPENQUEUE_RESERVED_* entries scales these reservations down to fit.
  *
  */
 #ifndef PACKETQUEUE_LENGTH
-#define PACKETQUEUE_LENGTH              20
+#define PACKETQUEUE_LENGTH              24
+#endif
+
+/**
+ * \def OPENQUEUE_RESERVED_CONTROL
+ *
+ * Entries of the packet queue reserved to control traffic (EB, KA, 6P) and to the frames received by the MAC. Control
+ * traffic may also use any other free entry.
+ *
+ */
+#ifndef OPENQUEUE_RESERVED_CONTROL
+#define OPENQUEUE_RESERVED_CONTROL      5
+#endif
+
+/**
+ * \def OPENQUEUE_RESERVED_RPL
+ *
+ * Entries of the packet queue reserved to RPL (DIO, DAO). Like the other classes below, RPL borrows the free entries
+ * which are not reserved to another class once its own are in use.
+ *
+ */
+#ifndef OPENQUEUE_RESERVED_RPL
+#define OPENQUEUE_RESERVED_RPL          2
+#endif
+
+/**
+ * \def OPENQUEUE_RESERVED_FORWARDED
+ *
+ * Entries of the packet queue reserved to relayed packets and fragments.
+ *
+ */
+#ifndef OPENQUEUE_RESERVED_FORWARDED
+#define OPENQUEUE_RESERVED_FORWARDED    4
+#endif
+
+/**
+ * \def OPENQUEUE_RESERVED_LOCAL
+ *
+ * Entries of the packet queue reserved to the packets originated by this mote (applications, ICMPv6 echo, ...).
+ *
+ */
+#ifndef OPENQUEUE_RESERVED_LOCAL
+#define OPENQUEUE_RESERVED_LOCAL        4
+#endif
+
+/**
+ * \def OPENQUEUE_DEBUG_ENABLE
+ *
+ * Prints the packet queue occupancy and the number of packets refused, per traffic class, over serial
+ * (STATUS_QUEUECLASSES).
+ *
+ */
+#ifndef OPENQUEUE_DEBUG_ENABLE
+#define OPENQUEUE_DEBUG_ENABLE (0)
+#endif
+
+/**
+ * \def RPL_STORING_MODE
+ *
+ * The DAGroot advertises the storing mode of operation instead of the non-storing one. Every node then sends its DAO
+ * to its parent, keeps a route to each target of the DAOs of its children, and forwards downward packets hop by hop
+ * without a source routing header. Other nodes follow the mode of the DODAG they join. The DAGroot handles these DAOs
+ * itself, and sends the packets of the bridge down along its routes.
+ *
+ */
+#ifndef RPL_STORING_MODE
+#define RPL_STORING_MODE (0)
+#endif
+
+/**
+ * \def ROUTINGTABLE_SIZE
+ *
+ * Number of routes to descendants kept in storing mode, a power of 2.
+ *
+ */
+#ifndef ROUTINGTABLE_SIZE
+#define ROUTINGTABLE_SIZE (16)
 #endif
 
 /**
@@ -397,6 +490,18 @@
 #define BOARD_CRYPTOENGINE_ENABLED (0)
 #endif
 
+/**
+ * \def BOARD_AES_TTABLE_ENABLED
+ *
+ * Use the 32-bit T-table implementation of the software AES instead of the byte-oriented one. It is faster on 32-bit
+ * boards (and the python board) without an AES engine, at the cost of a 1KB table in Flash. Its table lookups depend on
+ * the data, so it is not constant-time. It has no effect when BOARD_CRYPTOENGINE_ENABLED is set.
+ *
+ */
+#ifndef BOARD_AES_TTABLE_ENABLED
+#define BOARD_AES_TTABLE_ENABLED (0)
+#endif
+
 /**
  * \def BOARD_OPENSERIAL_PRINTF
  *
@@ -454,6 +559,93 @@
 #define SCHEDULER_DEBUG_ENABLE (0)
 #endif
 
+/**
+ * \def SCHEDULER_BUCKETS_ENABLE
+ *
+ * Selects the priority-bucketed task queue: free task containers are kept in a free list and pending tasks in one
+ * FIFO per priority level, indexed by a bitmap. Pushing and popping a task then run in constant time, instead of
+ * scanning the task buffer and walking the sorted task list with interrupts disabled.
+ *
+ */
+#ifndef SCHEDULER_BUCKETS_ENABLE
+#define SCHEDULER_BUCKETS_ENABLE (0)
+#endif
+
+/**
+ * \def SCHEDULER_OVERFLOW_POLICY_ENABLE
+ *
+ * Handles a task list overflow without resetting the board. A task whose callback is already pending is coalesced
+ * into it, otherwise the lowest-priority pending task is evicted if it is less important than the new one, otherwise
+ * the new task is dropped. Low-priority packet creators are also refused a packet buffer when the scheduler runs
+ * short of task containers.
+ *
+ */
+#ifndef SCHEDULER_OVERFLOW_POLICY_ENABLE
+#define SCHEDULER_OVERFLOW_POLICY_ENABLE (0)
+#endif
+
+/**
+ * \def SCHEDULER_PROFILE_ENABLE
+ *
+ * Timestamps each task when it is pushed and when it is dispatched, and keeps per-callback log2 histograms of the
+ * queueing delay and of the run time, in sctimer ticks. The table is printed over serial (STATUS_SCHEDULERPROFILE).
+ *
+ * Configuration options:
+ *  - SCHEDULER_PROFILE_NUM_TASKS: number of distinct task callbacks profiled. Default value is 8.
+ *  - SCHEDULER_PROFILE_NUM_BINS: number of histogram bins, bin i counting durations in [2^i, 2^(i+1)) ticks. Default
+ *  value is 12.
+ *
+ */
+#ifndef SCHEDULER_PROFILE_ENABLE
+#define SCHEDULER_PROFILE_ENABLE (0)
+#endif
+
+#if SCHEDULER_PROFILE_ENABLE
+#ifndef SCHEDULER_PROFILE_NUM_TASKS
+#define SCHEDULER_PROFILE_NUM_TASKS     8
+#endif
+#ifndef SCHEDULER_PROFILE_NUM_BINS
+#define SCHEDULER_PROFILE_NUM_BINS      12
+#endif
+#endif
+
+// ======================== Driver configuration ========================
+
+/**
+ * \def OPENTIMERS_SORTED_LIST_ENABLE
+ *
+ * Keeps the running opentimers in a doubly-linked list sorted by compare value. The next timer to fire is then the
+ * head of the list, and the compare interrupt only visits the timers that expire, instead of scanning the whole timer
+ * buffer twice.
+ *
+ */
+#ifndef OPENTIMERS_SORTED_LIST_ENABLE
+#define OPENTIMERS_SORTED_LIST_ENABLE (0)
+#endif
+
+/**
+ * \def OPENTIMERS_NUM_SPARE_TIMERS
+ *
+ * Number of opentimers added to the pool on top of the ones created by the enabled stack modules and applications, for
+ * projects that create their own timers. The pool size MAX_NUM_TIMERS is derived from the enabled modules in
+ * opentimers.h, and can also be given at build time.
+ *
+ */
+#ifndef OPENTIMERS_NUM_SPARE_TIMERS
+#define OPENTIMERS_NUM_SPARE_TIMERS (3)
+#endif
+
+/**
+ * \def OPENTIMERS_DEBUG_ENABLE
+ *
+ * Prints the timers in use over serial (STATUS_OPENTIMERS), one per status frame, with the component which created
+ * them, their period, and the pool occupancy and high-water mark. Helps sizing the pool and finding timer leaks.
+ *
+ */
+#ifndef OPENTIMERS_DEBUG_ENABLE
+#define OPENTIMERS_DEBUG_ENABLE (0)
+#endif
+
 #include "check_config.h"
 
 #endif /* OPENWSN_CONFIG_H */
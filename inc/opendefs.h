@@ -90,6 +90,7 @@ enum {
     IANA_ICMPv6_RPL_DIS = 0x00,
     IANA_ICMPv6_RPL_DIO = 0x01,
     IANA_ICMPv6_RPL_DAO = 0x02,
+    IANA_ICMPv6_RPL_DAO_ACK = 0x03,
     IANA_RSVP = 46,
     IANA_UNDEFINED = 250, //use an unassigned
 };
@@ -122,7 +123,10 @@ enum {
     STATUS_KAPERIOD = 10,
     STATUS_JOINED = 11,
     STATUS_MSF = 12,
-    STATUS_MAX = 13,
+    STATUS_SCHEDULERPROFILE = 13,
+    STATUS_OPENTIMERS = 14,
+    STATUS_QUEUECLASSES = 15,
+    STATUS_MAX = 16,
 };
 
 // component identifiers, order is important
@@ -329,6 +333,16 @@ typedef struct {  // always written big endian, i.e. MSB in addr[0]
 } open_addr_t;
 END_PACK
 
+typedef struct {
+    bool isUsed;                                               // the context is attached to a packet
+    cellInfo_ht celllist_add[CELLLIST_MAX_LEN];                // record celllist to be added and will be added when 6P response sendDone
+    cellInfo_ht celllist_delete[CELLLIST_MAX_LEN];             // record celllist to be removed and will be removed when 6P response sendDone
+    uint16_t frameID;                                          // frameID in 6P message
+    uint8_t command;                                           // command of the received 6p request, recorded in 6p response
+    uint8_t cellOptions;                                       // celloptions, used when 6p response senddone. (it's the same with cellOptions in 6p request but with TX and RX bits have been flipped)
+    uint8_t returnCode;                                        // return code in 6P response
+} OpenQueueSixtopContext_t;
+
 typedef struct {
    //admin
    uint8_t       creator;                                       // the component which called getFreePacketBuffer()
@@ -371,13 +385,8 @@ typedef struct {
     uint8_t l2_numTxAttempts;                                  // number Tx attempts
     asn_t l2_asn;                                              // at what ASN the packet was Tx'ed or Rx'ed
     uint8_t *l2_payload;                                       // pointer to the start of the payload of l2 (used for MAC to fill in ASN in ADV)
-    cellInfo_ht l2_sixtop_celllist_add[CELLLIST_MAX_LEN];      // record celllist to be added and will be added when 6P response sendDone
-    cellInfo_ht l2_sixtop_celllist_delete[CELLLIST_MAX_LEN];   // record celllist to be removed and will be removed when 6P response sendDone
-    uint16_t l2_sixtop_frameID;                                // frameID in 6P message
+    OpenQueueSixtopContext_t *l2_sixtop;                       // 6P response context, only attached to 6P responses (NULL otherwise)
     uint8_t l2_sixtop_messageType;                             // indicating the sixtop message type
-    uint8_t l2_sixtop_command;                                 // command of the received 6p request, recorded in 6p response
-    uint8_t l2_sixtop_cellOptions;                             // celloptions, used when 6p response senddone. (it's the same with cellOptions in 6p request but with TX and RX bits have been flipped)
-    uint8_t l2_sixtop_returnCode;                              // return code in 6P response
     uint8_t *l2_ASNpayload;                                    // pointer to the ASN in EB
     uint8_t *l2_nextHop_payload;                               // pointer to the nexthop address in frame
     uint8_t l2_joinPriority;                                   // the join priority received in EB
@@ -391,7 +400,6 @@ typedef struct {
     uint8_t l2_securityLevel;                                  // the security level specified for the current frame
     uint8_t l2_keyIdMode;                                      // the key Identifier mode specified for the current frame
     uint8_t l2_keyIndex;                                       // the key Index specified for the current frame
-    open_addr_t l2_keySource;                                  // the key Source specified for the current frame
     uint8_t l2_authenticationLength;                           // the length of the authentication field
     uint8_t commandFrameIdentifier;                            // used in case of Command Frames
     uint8_t *l2_FrameCounter;                                  // pointer to the FrameCounter in the MAC header
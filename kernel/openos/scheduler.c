@@ -9,35 +9,193 @@
 #include "board.h"
 #include "debugpins.h"
 #include "leds.h"
+#include "sctimer.h"
 
 //=========================== variables =======================================
 
 scheduler_vars_t scheduler_vars;
 
+#if SCHEDULER_BUCKETS_ENABLE
+// index of the lowest bit set in a 4-bit value
+static const uint8_t scheduler_ffs_nibble[16] = {
+    0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+#endif
+
 #if SCHEDULER_DEBUG_ENABLE
 scheduler_dbg_t scheduler_dbg;
 #endif
 
+#if SCHEDULER_PROFILE_ENABLE
+scheduler_prof_t scheduler_prof;
+#endif
+
 //=========================== prototypes ======================================
 
 void consumeTask(uint8_t taskId);
 
+#if SCHEDULER_BUCKETS_ENABLE
+uint8_t scheduler_findFirstSet(uint16_t bitmap);
+#endif
+
+#if SCHEDULER_OVERFLOW_POLICY_ENABLE
+taskList_item_t* scheduler_reclaimTask(task_cbt cb, task_prio_t prio);
+#endif
+
+void scheduler_taskQueued(task_prio_t prio);
+
+#if SCHEDULER_PROFILE_ENABLE
+void scheduler_profileTask(task_cbt cb, PORT_TIMER_WIDTH delay, PORT_TIMER_WIDTH runTime);
+uint8_t scheduler_profileBin(PORT_TIMER_WIDTH ticks);
+#endif
+
 //=========================== public ==========================================
 
 void scheduler_init(void) {
+#if SCHEDULER_BUCKETS_ENABLE
+    uint8_t i;
+#endif
 
     // initialization module variables
     memset(&scheduler_vars,0,sizeof(scheduler_vars_t));
 #if SCHEDULER_DEBUG_ENABLE
     memset(&scheduler_dbg,0,sizeof(scheduler_dbg_t));
 #endif
+#if SCHEDULER_PROFILE_ENABLE
+    memset(&scheduler_prof,0,sizeof(scheduler_prof_t));
+#endif
+
+#if SCHEDULER_BUCKETS_ENABLE
+    // chain all task containers into the free list
+    for (i=0;i<TASK_LIST_DEPTH-1;i++) {
+        scheduler_vars.taskBuf[i].next = &scheduler_vars.taskBuf[i+1];
+    }
+    scheduler_vars.free_list = &scheduler_vars.taskBuf[0];
+#endif
+    scheduler_vars.numTasksFree = TASK_LIST_DEPTH;
 
     // enable the scheduler's interrupt so SW can wake up the scheduler
     SCHEDULER_ENABLE_INTERRUPT();
 }
 
+#if SCHEDULER_BUCKETS_ENABLE
 void scheduler_start(void) {
     taskList_item_t* pThisTask;
+    uint8_t          prio;
+#if SCHEDULER_PROFILE_ENABLE
+    PORT_TIMER_WIDTH startedAt;
+#endif
+    while (1) {
+        while(scheduler_vars.bucket_bitmap!=0) {
+         // there is still at least one task in one of the priority buckets
+
+         INTERRUPT_DECLARATION();
+         DISABLE_INTERRUPTS();
+
+         // the task to execute is the head of the highest-priority non-empty bucket
+         prio                                = scheduler_findFirstSet(scheduler_vars.bucket_bitmap);
+         pThisTask                           = scheduler_vars.bucket_head[prio];
+
+         // shift that bucket by one task
+         scheduler_vars.bucket_head[prio]    = pThisTask->next;
+         if (scheduler_vars.bucket_head[prio]==NULL) {
+            scheduler_vars.bucket_tail[prio] = NULL;
+            scheduler_vars.bucket_bitmap    &= ~(1<<prio);
+         }
+         scheduler_vars.numTasksPerPrio[prio]--;
+
+         ENABLE_INTERRUPTS();
+
+         // execute the current task
+#if SCHEDULER_PROFILE_ENABLE
+         startedAt                           = sctimer_readCounter();
+         pThisTask->cb();
+         scheduler_profileTask(
+            pThisTask->cb,
+            startedAt-pThisTask->pushedAt,
+            sctimer_readCounter()-startedAt
+         );
+#else
+         pThisTask->cb();
+#endif
+
+         // return this task container to the free list
+         DISABLE_INTERRUPTS();
+         pThisTask->cb                       = NULL;
+         pThisTask->prio                     = TASKPRIO_NONE;
+         pThisTask->next                     = scheduler_vars.free_list;
+         scheduler_vars.free_list            = pThisTask;
+         scheduler_vars.numTasksFree++;
+#if SCHEDULER_DEBUG_ENABLE
+         scheduler_dbg.numTasksCur--;
+#endif
+         ENABLE_INTERRUPTS();
+      }
+      debugpins_task_clr();
+      board_sleep();
+      debugpins_task_set();                      // IAR should halt here if nothing to do
+   }
+}
+
+void scheduler_push_task(task_cbt cb, task_prio_t prio) {
+    taskList_item_t*  taskContainer;
+    INTERRUPT_DECLARATION();
+
+    DISABLE_INTERRUPTS();
+
+    // take a task container from the free list
+    taskContainer = scheduler_vars.free_list;
+    if (taskContainer!=NULL) {
+       scheduler_vars.free_list    = taskContainer->next;
+    } else {
+       // task list has overflown
+#if SCHEDULER_OVERFLOW_POLICY_ENABLE
+       taskContainer = scheduler_reclaimTask(cb, prio);
+       if (taskContainer==NULL) {
+          // task coalesced or dropped
+          ENABLE_INTERRUPTS();
+          return;
+       }
+#else
+       // we can not print from within the kernel. Instead:
+       // blink the error LED
+       leds_error_blink();
+       // reset the board
+       board_reset();
+
+       ENABLE_INTERRUPTS();
+       return;
+#endif
+    }
+
+    // fill that task container with this task
+    taskContainer->cb              = cb;
+    taskContainer->prio            = prio;
+    taskContainer->next            = NULL;
+#if SCHEDULER_PROFILE_ENABLE
+    taskContainer->pushedAt        = sctimer_readCounter();
+#endif
+
+    // append to the tail of the bucket of that priority
+    if (scheduler_vars.bucket_tail[prio]==NULL) {
+       scheduler_vars.bucket_head[prio]        = taskContainer;
+    } else {
+       scheduler_vars.bucket_tail[prio]->next  = taskContainer;
+    }
+    scheduler_vars.bucket_tail[prio]           = taskContainer;
+    scheduler_vars.bucket_bitmap              |= (1<<prio);
+
+    // maintain stats
+    scheduler_taskQueued(prio);
+
+    ENABLE_INTERRUPTS();
+}
+#else
+void scheduler_start(void) {
+    taskList_item_t* pThisTask;
+#if SCHEDULER_PROFILE_ENABLE
+    PORT_TIMER_WIDTH startedAt;
+#endif
     while (1) {
         while(scheduler_vars.task_list!=NULL) {
          // there is still at least one task in the linked-list of tasks
@@ -50,19 +208,33 @@ void scheduler_start(void) {
 
          // shift the queue by one task
          scheduler_vars.task_list = pThisTask->next;
+         scheduler_vars.numTasksPerPrio[pThisTask->prio]--;
 
          ENABLE_INTERRUPTS();
 
          // execute the current task
+#if SCHEDULER_PROFILE_ENABLE
+         startedAt                = sctimer_readCounter();
+         pThisTask->cb();
+         scheduler_profileTask(
+            pThisTask->cb,
+            startedAt-pThisTask->pushedAt,
+            sctimer_readCounter()-startedAt
+         );
+#else
          pThisTask->cb();
+#endif
 
          // free up this task container
+         DISABLE_INTERRUPTS();
          pThisTask->cb            = NULL;
          pThisTask->prio          = TASKPRIO_NONE;
          pThisTask->next          = NULL;
+         scheduler_vars.numTasksFree++;
 #if SCHEDULER_DEBUG_ENABLE
          scheduler_dbg.numTasksCur--;
 #endif
+         ENABLE_INTERRUPTS();
       }
       debugpins_task_clr();
       board_sleep();
@@ -84,17 +256,28 @@ void scheduler_push_task(task_cbt cb, task_prio_t prio) {
        taskContainer++;
     }
     if (taskContainer>&scheduler_vars.taskBuf[TASK_LIST_DEPTH-1]) {
-       // task list has overflown. This should never happpen!
-
+       // task list has overflown
+#if SCHEDULER_OVERFLOW_POLICY_ENABLE
+       taskContainer = scheduler_reclaimTask(cb, prio);
+       if (taskContainer==NULL) {
+          // task coalesced or dropped
+          ENABLE_INTERRUPTS();
+          return;
+       }
+#else
        // we can not print from within the kernel. Instead:
        // blink the error LED
        leds_error_blink();
        // reset the board
        board_reset();
+#endif
     }
     // fill that task container with this task
     taskContainer->cb              = cb;
     taskContainer->prio            = prio;
+#if SCHEDULER_PROFILE_ENABLE
+    taskContainer->pushedAt        = sctimer_readCounter();
+#endif
 
     // find position in queue
     taskListWalker                 = &scheduler_vars.task_list;
@@ -105,17 +288,47 @@ void scheduler_push_task(task_cbt cb, task_prio_t prio) {
     // insert at that position
     taskContainer->next            = *taskListWalker;
     *taskListWalker                = taskContainer;
-    // maintain debug stats
-#if SCHEDULER_DEBUG_ENABLE
-    scheduler_dbg.numTasksCur++;
-    if (scheduler_dbg.numTasksCur>scheduler_dbg.numTasksMax) {
-        scheduler_dbg.numTasksMax   = scheduler_dbg.numTasksCur;
-    }
-#endif
+    // maintain stats
+    scheduler_taskQueued(prio);
 
     ENABLE_INTERRUPTS();
 }
+#endif
+
+/**
+\brief Number of task containers not currently holding a task.
+
+Producers of work, such as callers of openqueue_getFreePacketBuffer(), can read
+this to back off before the task list overflows.
+*/
+uint8_t scheduler_getNumTasksFree(void) {
+    return scheduler_vars.numTasksFree;
+}
+
+/**
+\brief Largest number of tasks of a given priority pending at the same time.
+*/
+uint8_t scheduler_getHighWaterMark(task_prio_t prio) {
+    return scheduler_vars.highWaterMark[prio];
+}
+
+#if SCHEDULER_PROFILE_ENABLE
+/**
+\brief Retrieve the next row of the task profile table.
+
+Successive calls walk the table round-robin, for printing it over serial one
+row at a time.
+
+\param[out] profile Where to copy the row.
 
+\returns The index of the row copied.
+*/
+uint8_t scheduler_getNextTaskProfile(taskProfile_item_t* profile) {
+    scheduler_prof.debugPrintRow = (scheduler_prof.debugPrintRow+1)%SCHEDULER_PROFILE_NUM_TASKS;
+    memcpy(profile,&scheduler_prof.taskProfileBuf[scheduler_prof.debugPrintRow],sizeof(taskProfile_item_t));
+    return scheduler_prof.debugPrintRow;
+}
+#endif
 
 #if SCHEDULER_DEBUG_ENABLE
 uint8_t scheduler_debug_get_TasksCur(void)
@@ -128,4 +341,219 @@ uint8_t scheduler_debug_get_TasksMax(void)
    return scheduler_dbg.numTasksMax;
 }
 #endif
+
 //=========================== private =========================================
+
+#if SCHEDULER_BUCKETS_ENABLE
+/**
+\brief Find the index of the lowest bit set in the priority bitmap.
+
+The lowest bit set corresponds to the highest-priority non-empty bucket. The
+lookup is done one nibble at a time so it runs in constant time on targets
+without a count-trailing-zeros instruction.
+
+\param[in] bitmap The bucket bitmap, must not be 0.
+
+\returns The index of the lowest bit set.
+*/
+uint8_t scheduler_findFirstSet(uint16_t bitmap) {
+    if (bitmap & 0x00ff) {
+        if (bitmap & 0x000f) {
+            return scheduler_ffs_nibble[bitmap & 0x0f];
+        }
+        return 4 + scheduler_ffs_nibble[(bitmap >> 4) & 0x0f];
+    }
+    if (bitmap & 0x0f00) {
+        return 8 + scheduler_ffs_nibble[(bitmap >> 8) & 0x0f];
+    }
+    return 12 + scheduler_ffs_nibble[(bitmap >> 12) & 0x0f];
+}
+#endif
+
+#if SCHEDULER_OVERFLOW_POLICY_ENABLE
+/**
+\brief Make room for a task when all task containers are in use.
+
+Called with interrupts disabled. The policy is applied in this order:
+- if the same callback is already pending, the new task is coalesced into it;
+- otherwise, if the lowest-priority pending task has a lower priority than the
+  new one, that task is evicted and its container is handed back;
+- otherwise, the new task is dropped.
+
+\param[in] cb   The callback of the task being pushed.
+\param[in] prio The priority of the task being pushed.
+
+\returns The container to store the new task in, or NULL when the new task
+         was coalesced or dropped.
+*/
+taskList_item_t* scheduler_reclaimTask(task_cbt cb, task_prio_t prio) {
+    taskList_item_t* pending;
+    taskList_item_t* victim;
+    taskList_item_t* victimPrev;
+#if SCHEDULER_BUCKETS_ENABLE
+    uint8_t          p;
+#endif
+
+    // coalesce with an identical pending task
+#if SCHEDULER_BUCKETS_ENABLE
+    for (p=0;p<TASKPRIO_MAX;p++) {
+        for (pending=scheduler_vars.bucket_head[p];pending!=NULL;pending=pending->next) {
+            if (pending->cb==cb) {
+                scheduler_vars.numTasksCoalesced++;
+                return NULL;
+            }
+        }
+    }
+#else
+    for (pending=scheduler_vars.task_list;pending!=NULL;pending=pending->next) {
+        if (pending->cb==cb) {
+            scheduler_vars.numTasksCoalesced++;
+            return NULL;
+        }
+    }
+#endif
+
+    // find the lowest-priority pending task, the most recent one on ties
+#if SCHEDULER_BUCKETS_ENABLE
+    if (scheduler_vars.bucket_bitmap==0) {
+        scheduler_vars.numTasksDropped++;
+        return NULL;
+    }
+    p = TASKPRIO_MAX-1;
+    while ((scheduler_vars.bucket_bitmap & (1<<p))==0) {
+        p--;
+    }
+    victim     = scheduler_vars.bucket_head[p];
+#else
+    victim     = scheduler_vars.task_list;
+    if (victim==NULL) {
+        scheduler_vars.numTasksDropped++;
+        return NULL;
+    }
+#endif
+    victimPrev = NULL;
+    while (victim->next!=NULL) {
+        victimPrev = victim;
+        victim     = victim->next;
+    }
+
+    if (victim->prio<=prio) {
+        // the new task is the least important one, drop it
+        scheduler_vars.numTasksDropped++;
+        return NULL;
+    }
+
+    // evict the victim
+#if SCHEDULER_BUCKETS_ENABLE
+    if (victimPrev==NULL) {
+        scheduler_vars.bucket_head[p]    = NULL;
+        scheduler_vars.bucket_bitmap    &= ~(1<<p);
+    } else {
+        victimPrev->next                 = NULL;
+    }
+    scheduler_vars.bucket_tail[p]        = victimPrev;
+#else
+    if (victimPrev==NULL) {
+        scheduler_vars.task_list         = NULL;
+    } else {
+        victimPrev->next                 = NULL;
+    }
+#endif
+    scheduler_vars.numTasksPerPrio[victim->prio]--;
+    scheduler_vars.numTasksFree++;
+    scheduler_vars.numTasksEvicted++;
+#if SCHEDULER_DEBUG_ENABLE
+    scheduler_dbg.numTasksCur--;
+#endif
+
+    victim->cb                           = NULL;
+    victim->prio                         = TASKPRIO_NONE;
+    victim->next                         = NULL;
+
+    return victim;
+}
+#endif
+
+#if SCHEDULER_PROFILE_ENABLE
+/**
+\brief Record the queueing delay and run time of a task which just ran.
+
+Rows are allocated to callbacks on first run. Once the table is full, runs of
+callbacks without a row are only counted.
+
+\param[in] cb      The callback which ran.
+\param[in] delay   Ticks between the push and the dispatch of the task.
+\param[in] runTime Ticks spent in the callback.
+*/
+void scheduler_profileTask(task_cbt cb, PORT_TIMER_WIDTH delay, PORT_TIMER_WIDTH runTime) {
+    taskProfile_item_t* row;
+    taskProfile_item_t* freeRow;
+    uint8_t             bin;
+
+    freeRow = NULL;
+    for (row=&scheduler_prof.taskProfileBuf[0];row<&scheduler_prof.taskProfileBuf[SCHEDULER_PROFILE_NUM_TASKS];row++) {
+        if (row->cb==cb) {
+            break;
+        }
+        if (row->cb==NULL && freeRow==NULL) {
+            freeRow = row;
+        }
+    }
+    if (row==&scheduler_prof.taskProfileBuf[SCHEDULER_PROFILE_NUM_TASKS]) {
+        if (freeRow==NULL) {
+            scheduler_prof.numRunsUnprofiled++;
+            return;
+        }
+        row     = freeRow;
+        row->cb = cb;
+    }
+
+    // counters saturate rather than wrap
+    if (row->numRuns<0xffff) {
+        row->numRuns++;
+    }
+    bin = scheduler_profileBin(delay);
+    if (row->delayHist[bin]<0xffff) {
+        row->delayHist[bin]++;
+    }
+    bin = scheduler_profileBin(runTime);
+    if (row->runHist[bin]<0xffff) {
+        row->runHist[bin]++;
+    }
+}
+
+/**
+\brief Histogram bin of a duration: bin i holds [2^i, 2^(i+1)) ticks.
+
+Bin 0 also holds 0 ticks, and the last bin holds everything above it.
+*/
+uint8_t scheduler_profileBin(PORT_TIMER_WIDTH ticks) {
+    uint8_t bin;
+
+    bin = 0;
+    while (ticks>1 && bin<SCHEDULER_PROFILE_NUM_BINS-1) {
+        ticks >>= 1;
+        bin++;
+    }
+    return bin;
+}
+#endif
+
+/**
+\brief Account for a task which was just inserted in the task list.
+
+Called with interrupts disabled.
+*/
+void scheduler_taskQueued(task_prio_t prio) {
+    scheduler_vars.numTasksFree--;
+    scheduler_vars.numTasksPerPrio[prio]++;
+    if (scheduler_vars.numTasksPerPrio[prio]>scheduler_vars.highWaterMark[prio]) {
+        scheduler_vars.highWaterMark[prio] = scheduler_vars.numTasksPerPrio[prio];
+    }
+#if SCHEDULER_DEBUG_ENABLE
+    scheduler_dbg.numTasksCur++;
+    if (scheduler_dbg.numTasksCur>scheduler_dbg.numTasksMax) {
+        scheduler_dbg.numTasksMax   = scheduler_dbg.numTasksCur;
+    }
+#endif
+}
@@ -14,11 +14,29 @@ typedef struct task_llist_t {
    task_cbt                       cb;
    task_prio_t                    prio;
    void*                          next;
+#if SCHEDULER_PROFILE_ENABLE
+   PORT_TIMER_WIDTH               pushedAt;                         // sctimer counter when pushed
+#endif
 } taskList_item_t;
 
 typedef struct {
    taskList_item_t                taskBuf[TASK_LIST_DEPTH];
+#if SCHEDULER_BUCKETS_ENABLE
+   taskList_item_t*               free_list;                        // unused task containers
+   taskList_item_t*               bucket_head[TASKPRIO_MAX];        // FIFO of pending tasks, one per priority
+   taskList_item_t*               bucket_tail[TASKPRIO_MAX];
+   uint16_t                       bucket_bitmap;                    // bit i set when bucket i is not empty
+#else
    taskList_item_t*               task_list;
+#endif
+   uint8_t                        numTasksFree;                     // containers not holding a task
+   uint8_t                        numTasksPerPrio[TASKPRIO_MAX];    // pending tasks, per priority
+   uint8_t                        highWaterMark[TASKPRIO_MAX];      // max pending tasks, per priority
+#if SCHEDULER_OVERFLOW_POLICY_ENABLE
+   uint16_t                       numTasksCoalesced;                // overflows absorbed by an identical pending task
+   uint16_t                       numTasksEvicted;                  // lower-priority tasks dropped to make room
+   uint16_t                       numTasksDropped;                  // new tasks dropped
+#endif
 } scheduler_vars_t;
 
 #if SCHEDULER_DEBUG_ENABLE
@@ -28,6 +46,30 @@ typedef struct {
 } scheduler_dbg_t;
 #endif
 
+#if SCHEDULER_PROFILE_ENABLE
+BEGIN_PACK
+typedef struct {
+   task_cbt                       cb;
+   uint16_t                       numRuns;
+   uint16_t                       delayHist[SCHEDULER_PROFILE_NUM_BINS];   // log2 of ticks from push to dispatch
+   uint16_t                       runHist[SCHEDULER_PROFILE_NUM_BINS];     // log2 of ticks spent running
+} taskProfile_item_t;
+END_PACK
+
+BEGIN_PACK
+typedef struct {
+   uint8_t                        row;
+   taskProfile_item_t             taskProfile;
+} debugTaskProfileEntry_t;
+END_PACK
+
+typedef struct {
+   taskProfile_item_t             taskProfileBuf[SCHEDULER_PROFILE_NUM_TASKS];
+   uint16_t                       numRunsUnprofiled;                // runs of tasks which did not fit in taskProfileBuf
+   uint8_t                        debugPrintRow;
+} scheduler_prof_t;
+#endif
+
 /**
 \}
 \}
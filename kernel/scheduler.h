@@ -49,6 +49,8 @@ typedef void (*task_cbt)(void);
 void scheduler_init(void);
 void scheduler_start(void);
 void scheduler_push_task(task_cbt task_cb, task_prio_t prio);
+uint8_t scheduler_getNumTasksFree(void);
+uint8_t scheduler_getHighWaterMark(task_prio_t prio);
 
 #if SCHEDULER_DEBUG_ENABLE
 uint8_t scheduler_debug_get_TasksCur(void);
@@ -57,6 +59,10 @@ uint8_t scheduler_debug_get_TasksMax(void);
 
 #include "openos/scheduler_types.h"
 
+#if SCHEDULER_PROFILE_ENABLE
+uint8_t scheduler_getNextTaskProfile(taskProfile_item_t* profile);
+#endif
+
 /**
 \}
 \}
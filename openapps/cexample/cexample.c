@@ -63,7 +63,7 @@ void cexample_init(void) {
 
 
     coap_register(&cexample_vars.desc);
-    cexample_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP);
+    cexample_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP, COMPONENT_CEXAMPLE);
     opentimers_scheduleIn(
             cexample_vars.timerId,
             CEXAMPLEPERIOD,
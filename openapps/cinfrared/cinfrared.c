@@ -59,7 +59,7 @@ void cinfrared_init(void) {
 
     coap_register(&cinfrared_vars.desc);
 
-    cinfrared_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP);
+    cinfrared_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP, COMPONENT_CINFRARED);
 }
 
 //=========================== private =========================================
@@ -86,7 +86,7 @@ void cjoin_init(void) {
 
     coap_register(&cjoin_vars.desc);
 
-    cjoin_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP);
+    cjoin_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP, COMPONENT_CJOIN);
 
     idmanager_setJoinKey((uint8_t *) masterSecret);
 
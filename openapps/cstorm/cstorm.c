@@ -64,7 +64,7 @@ void cstorm_init(void) {
     /*
     cstorm_vars.period           = 6553;
 
-    cstorm_vars.timerId          = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP);
+    cstorm_vars.timerId          = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP, COMPONENT_CSTORM);
     opentimers_scheduleIn(
         cstorm_vars.timerId,
         cstorm_vars.period,
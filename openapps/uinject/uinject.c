@@ -62,7 +62,7 @@ void uinject_init(void) {
 
     // start periodic timer
     uinject_vars.period = UINJECT_PERIOD_MS;
-    uinject_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_UDP);
+    uinject_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_UDP, COMPONENT_UINJECT);
     opentimers_scheduleIn(
             uinject_vars.timerId,
             UINJECT_PERIOD_MS,
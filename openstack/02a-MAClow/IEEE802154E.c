@@ -113,7 +113,7 @@ void timeslotTemplateIDStoreFromEB(uint8_t id);
 void channelhoppingTemplateIDStoreFromEB(uint8_t id);
 
 // ASN handling
-void incrementAsnOffset(void);
+void incrementAsnOffset(uint16_t numSlots);
 
 void ieee154e_resetAsn(void);
 
@@ -147,6 +147,11 @@ void changeState(ieee154e_state_t newstate);
 
 void endSlot(void);
 
+// securing frames
+owerror_t loadTxFrame(void);
+
+void prepareNextTx(void);
+
 bool debugPrint_asn(void);
 
 bool debugPrint_isSync(void);
@@ -204,7 +209,7 @@ void ieee154e_init(void) {
     radio_setStartFrameCb(ieee154e_startOfFrame);
     radio_setEndFrameCb(ieee154e_endOfFrame);
     // have the radio start its timer and assign ieee802154e timer with highest priority
-    ieee154e_vars.timerId = opentimers_create(TIMER_TSCH, TASKPRIO_NONE);
+    ieee154e_vars.timerId = opentimers_create(TIMER_TSCH, TASKPRIO_NONE, COMPONENT_IEEE802154E);
     opentimers_scheduleAbsolute(
             ieee154e_vars.timerId,          // timerId
             ieee154e_vars.slotDuration,     // duration
@@ -213,7 +218,7 @@ void ieee154e_init(void) {
             isr_ieee154e_newSlot            // callback
     );
     IEEE802154_security_init();
-    ieee154e_vars.serialInhibitTimerId = opentimers_create(TIMER_INHIBIT, TASKPRIO_NONE);
+    ieee154e_vars.serialInhibitTimerId = opentimers_create(TIMER_INHIBIT, TASKPRIO_NONE, COMPONENT_IEEE802154E);
 }
 
 //=========================== public ==========================================
@@ -345,7 +350,7 @@ void isr_ieee154e_newSlot(opentimers_id_t id) {
         if (idmanager_getIsDAGroot() == TRUE) {
             changeIsSync(TRUE);
             ieee154e_resetAsn();
-            ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
+            schedule_syncAsn(&ieee154e_vars.asn);
         } else {
             activity_synchronize_newSlot();
         }
@@ -883,8 +888,7 @@ port_INLINE bool ieee154e_processIEs(OpenQueueEntry_t* pkt, uint16_t* lenIE) {
     if (isValidEbFormat(pkt, lenIE) == TRUE){
         // At this point, ASN and frame length are known and the current slotoffset can be inferred
         ieee154e_syncSlotOffset();
-        schedule_syncSlotOffset(ieee154e_vars.slotOffset);
-        ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
+        schedule_syncAsn(&ieee154e_vars.asn);
 
         /* infer the asnOffset based on the fact that ieee154e_vars.freq = 11 + (asnOffset + channelOffset)%16 */
         for (i = 0; i < NUM_CHANNELS; i++){
@@ -906,13 +910,12 @@ port_INLINE bool ieee154e_processIEs(OpenQueueEntry_t* pkt, uint16_t* lenIE) {
 port_INLINE void activity_ti1ORri1(void) {
     cellType_t cellType;
     open_addr_t neighbor;
-    uint8_t i;
     uint8_t asn[5];
     uint8_t join_priority;
     bool couldSendEB = FALSE;
 
-    // increment ASN (do this first so debug pins are in sync)
-    incrementAsnOffset();
+    // increment ASN by the slots elapsed since the previous wake-up (do this first so debug pins are in sync)
+    incrementAsnOffset(ieee154e_vars.numOfSleepSlots);
 
     // wiggle debug pins
     debugpins_slot_toggle();
@@ -925,9 +928,6 @@ port_INLINE void activity_ti1ORri1(void) {
         if (ieee154e_vars.deSyncTimeout > ieee154e_vars.numOfSleepSlots) {
             ieee154e_vars.deSyncTimeout -= ieee154e_vars.numOfSleepSlots;
         } else {
-            // Reset sleep slots
-            ieee154e_vars.numOfSleepSlots = 1;
-
             // declare myself desynchronized
             changeIsSync(FALSE);
 
@@ -948,6 +948,9 @@ port_INLINE void activity_ti1ORri1(void) {
         }
     }
 
+    // the slots skipped since the previous wake-up have been accounted for
+    ieee154e_vars.numOfSleepSlots = 1;
+
     // if the previous slot took too long, we will not be in the right state
     if (ieee154e_vars.state != S_SLEEP) {
         // log the error
@@ -959,12 +962,8 @@ port_INLINE void activity_ti1ORri1(void) {
         return;
     }
 
-    // Reset sleep slots
-    ieee154e_vars.numOfSleepSlots = 1;
-
-    // update nextActiveSlotOffset before using
-    ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
-    if (ieee154e_vars.slotOffset == ieee154e_vars.nextActiveSlotOffset) {
+    // the schedule catches up with the ASN if a slot was aborted or skipped since it last moved
+    if (schedule_isNextActiveSlot(&ieee154e_vars.asn)) {
         // this is the next active slot
 
         // advance the schedule
@@ -973,28 +972,27 @@ port_INLINE void activity_ti1ORri1(void) {
         // calculate the frequency to transmit on
         ieee154e_vars.freq = calculateFrequency(schedule_getChannelOffset());
 
-        // find the next one
-        ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
         if (idmanager_getIsSlotSkip() && idmanager_getIsDAGroot() == FALSE) {
-            if (ieee154e_vars.nextActiveSlotOffset > ieee154e_vars.slotOffset) {
-                ieee154e_vars.numOfSleepSlots = ieee154e_vars.nextActiveSlotOffset - ieee154e_vars.slotOffset;
-            } else {
-                ieee154e_vars.numOfSleepSlots =
-                        schedule_getFrameLength() + ieee154e_vars.nextActiveSlotOffset - ieee154e_vars.slotOffset;
+            // sleep through the idle slots up to the next active slot of any slotframe, the ASN is advanced by
+            // numOfSleepSlots when waking up
+            ieee154e_vars.numOfSleepSlots = schedule_getSlotsToNextActiveSlot();
+            if (ieee154e_vars.numOfSleepSlots == 0) {
+                ieee154e_vars.numOfSleepSlots = 1;
             }
 
-            opentimers_scheduleAbsolute(
-                    ieee154e_vars.timerId,                            // timerId
-                    TsSlotDuration * (ieee154e_vars.numOfSleepSlots),   // duration
-                    ieee154e_vars.startOfSlotReference,               // reference
-                    TIME_TICS,                                        // timetype
-                    isr_ieee154e_newSlot                              // callback
-            );
-            ieee154e_vars.slotDuration = TsSlotDuration * (ieee154e_vars.numOfSleepSlots);
-
-            //increase ASN by numOfSleepSlots-1 slots as at this slot is already incremented by 1
-            for (i = 0; i < ieee154e_vars.numOfSleepSlots - 1; i++) {
-                incrementAsnOffset();
+            if (ieee154e_vars.numOfSleepSlots > 1) {
+                opentimers_scheduleAbsolute(
+                        ieee154e_vars.timerId,                            // timerId
+                        TsSlotDuration * ieee154e_vars.numOfSleepSlots,   // duration
+                        ieee154e_vars.startOfSlotReference,               // reference
+                        TIME_TICS,                                        // timetype
+                        isr_ieee154e_newSlot                              // callback
+                );
+#if OPENWSN_ADAPTIVE_SYNC_C
+                // the slots slept through are not counted at the next wake-up
+                adaptive_sync_countCompensationTimeout_compoundSlots(ieee154e_vars.numOfSleepSlots - 1);
+#endif
+                ieee154e_vars.slotDuration = TsSlotDuration * ieee154e_vars.numOfSleepSlots;
             }
         }
     } else {
@@ -1066,34 +1064,17 @@ port_INLINE void activity_ti1ORri1(void) {
 #ifdef SLOT_FSM_IMPLEMENTATION_MULTIPLE_TIMER_INTERRUPT
                 // 1. schedule timer for loading packet
                 sctimer_scheduleActionIn(ACTION_LOAD_PACKET, ieee154e_vars.startOfSlotReference+DURATION_tt1);
-                // prepare the packet for load packet action at DURATION_tt1
-                // make a local copy of the frame
-                packetfunctions_duplicatePacket(&ieee154e_vars.localCopyForTransmission, ieee154e_vars.dataToSend);
-
-                // check if packet needs to be encrypted/authenticated before transmission
-                if (ieee154e_vars.localCopyForTransmission.l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) { // security enabled
-                    // encrypt in a local copy
-                    if (IEEE802154_security_outgoingFrameSecurity(&ieee154e_vars.localCopyForTransmission) != E_SUCCESS) {
-                        // keep the frame in the OpenQueue in order to retry later
-                        endSlot(); // abort
-                        return;
-                    }
-                }
-
-                // add 2 CRC bytes only to the local copy as we end up here for each retransmission
-                OpenQueueEntry_t* copy;
-                localCopy = &ieee154e_vars.localCopyForTransmission;
-                if (packetfunctions_reserveFooter(&localCopy, 2) == E_FAIL){
-                    endSlot();
+                // prepare the packet for load packet action at DURATION_tt1, encrypted/authenticated if needed
+                if (loadTxFrame() != E_SUCCESS) {
+                    endSlot(); // abort
                     return;
                 }
-                
+
                 // configure the radio to listen to the default synchronizing channel
                 radio_setFrequency(ieee154e_vars.freq, FREQ_TX);
 
                 // set the tx buffer address and length register.(packet is NOT loaded at this moment)
-                radio_loadPacket_prepare(ieee154e_vars.localCopyForTransmission.payload,
-                                     ieee154e_vars.localCopyForTransmission.length);
+                radio_loadPacket_prepare(ieee154e_vars.txFrame, ieee154e_vars.txFrameLength);
                 // 2. schedule timer for sending packet
                 sctimer_scheduleActionIn(ACTION_SEND_PACKET,  ieee154e_vars.startOfSlotReference+DURATION_tt2);
                 // 3. schedule timer radio tx watchdog
@@ -1167,28 +1148,9 @@ port_INLINE void activity_ti2(void) {
             TIME_TICS,                                        // timetype
             isr_ieee154e_timer                                // callback
     );
-    // make a local copy of the frame
-    packetfunctions_duplicatePacket(&ieee154e_vars.localCopyForTransmission, ieee154e_vars.dataToSend);
-
-    // check if packet needs to be encrypted/authenticated before transmission
-    if (ieee154e_vars.localCopyForTransmission.l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) { // security enabled
-        // encrypt in a local copy
-        if (IEEE802154_security_outgoingFrameSecurity(&ieee154e_vars.localCopyForTransmission) != E_SUCCESS) {
-            // keep the frame in the OpenQueue in order to retry later
-            endSlot(); // abort
-            return;
-        }
-    }
-
-    // add 2 CRC bytes only to the local copy as we end up here for each retransmission
-
-    OpenQueueEntry_t* localCopy;
-    localCopy = &ieee154e_vars.localCopyForTransmission;
-    if (packetfunctions_reserveFooter(&localCopy, 2) == E_FAIL){
-        // packet too big, will never successfully be transmitted, drop immediately
-        // set retries to 1, so after it get decremented in endSlot, we drop the packet
-        ieee154e_vars.dataToSend->l2_retriesLeft = 1;
-        endSlot();
+    // get the frame to load, encrypted/authenticated if needed
+    if (loadTxFrame() != E_SUCCESS) {
+        endSlot(); // abort
         return;
     }
 
@@ -1196,7 +1158,7 @@ port_INLINE void activity_ti2(void) {
     radio_setFrequency(ieee154e_vars.freq, FREQ_TX);
 
     // load the packet in the radio's Tx buffer
-    radio_loadPacket(ieee154e_vars.localCopyForTransmission.payload, ieee154e_vars.localCopyForTransmission.length);
+    radio_loadPacket(ieee154e_vars.txFrame, ieee154e_vars.txFrameLength);
 #endif
     // enable the radio in Tx mode. This does not send the packet.
     radio_txEnable();
@@ -1430,7 +1392,7 @@ port_INLINE void activity_tie5(void) {
         notif_sendDone(ieee154e_vars.dataToSend, E_FAIL);
     } else {
         // return packet to the virtual COMPONENT_SIXTOP_TO_IEEE802154E component
-        ieee154e_vars.dataToSend->owner = COMPONENT_SIXTOP_TO_IEEE802154E;
+        openqueue_macPutPacket(ieee154e_vars.dataToSend);
     }
 
     // reset local variable
@@ -1924,7 +1886,8 @@ port_INLINE void activity_ri5(PORT_TIMER_WIDTH capturedTime) {
 
             // if security is enabled, encrypt directly in OpenQueue as there are no retransmissions for ACKs
             if (ieee154e_vars.ackToSend->l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) {
-                if (IEEE802154_security_outgoingFrameSecurity(ieee154e_vars.ackToSend) != E_SUCCESS) {
+                if (IEEE802154_security_outgoingFrameSecurity(ieee154e_vars.ackToSend, &ieee154e_vars.asn,
+                                                              ieee154e_vars.ackToSend->payload) != E_SUCCESS) {
                     openqueue_freePacketBuffer(ieee154e_vars.ackToSend);
                     endSlot();
                     return;
@@ -2059,7 +2022,8 @@ port_INLINE void activity_ri6(void) {
 
     // if security is enabled, encrypt directly in OpenQueue as there are no retransmissions for ACKs
     if (ieee154e_vars.ackToSend->l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) {
-        if (IEEE802154_security_outgoingFrameSecurity(ieee154e_vars.ackToSend) != E_SUCCESS) {
+        if (IEEE802154_security_outgoingFrameSecurity(ieee154e_vars.ackToSend, &ieee154e_vars.asn,
+                                                      ieee154e_vars.ackToSend->payload) != E_SUCCESS) {
             openqueue_freePacketBuffer(ieee154e_vars.ackToSend);
             endSlot();
             return;
@@ -2256,12 +2220,15 @@ port_INLINE bool isValidAck(ieee802154_header_iht* ieee802514_header, OpenQueueE
 
 //======= ASN handling
 
-port_INLINE void incrementAsnOffset(void) {
+/**
+\brief Move the ASN and the offsets derived from it numSlots slots forward.
+*/
+port_INLINE void incrementAsnOffset(uint16_t numSlots) {
     frameLength_t frameLength;
 
     // increment the asn
-    ieee154e_vars.asn.bytes0and1++;
-    if (ieee154e_vars.asn.bytes0and1 == 0) {
+    ieee154e_vars.asn.bytes0and1 += numSlots;
+    if (ieee154e_vars.asn.bytes0and1 < numSlots) {
         ieee154e_vars.asn.bytes2and3++;
         if (ieee154e_vars.asn.bytes2and3 == 0) {
             ieee154e_vars.asn.byte4++;
@@ -2271,11 +2238,11 @@ port_INLINE void incrementAsnOffset(void) {
     // increment the offsets
     frameLength = schedule_getFrameLength();
     if (frameLength == 0) {
-        ieee154e_vars.slotOffset++;
+        ieee154e_vars.slotOffset += numSlots;
     } else {
-        ieee154e_vars.slotOffset = (ieee154e_vars.slotOffset + 1) % frameLength;
+        ieee154e_vars.slotOffset = ((uint32_t) ieee154e_vars.slotOffset + numSlots) % frameLength;
     }
-    ieee154e_vars.asnOffset = (ieee154e_vars.asnOffset + 1) % NUM_CHANNELS;
+    ieee154e_vars.asnOffset = (ieee154e_vars.asnOffset + numSlots) % NUM_CHANNELS;
 }
 
 port_INLINE void ieee154e_resetAsn(void) {
@@ -2309,6 +2276,17 @@ void ieee154e_getTicsInfo(uint32_t *numTicsOn, uint32_t *numTicsTotal) {
     *numTicsTotal = (uint32_t)(ieee154e_stats.numTicsTotal);
 }
 
+/**
+\brief Forget the frame secured ahead of its slot, as its content or key changed.
+
+\param[in] pkt The frame which changed, NULL for any frame.
+*/
+void ieee154e_invalidatePreparedFrame(OpenQueueEntry_t *pkt) {
+    if (pkt == NULL || pkt == ieee154e_vars.preparedFrame) {
+        ieee154e_vars.preparedFrame = NULL;
+    }
+}
+
 port_INLINE void joinPriorityStoreFromEB(uint8_t jp) {
     ieee154e_vars.dataReceived->l2_joinPriority = jp;
     ieee154e_vars.dataReceived->l2_joinPriorityPresent = TRUE;
@@ -2536,8 +2514,7 @@ port_INLINE void ieee154e_syncSlotOffset(void) {
 
     ieee154e_vars.slotOffset = (slotOffset_t) slotOffset;
 
-    schedule_syncSlotOffset(ieee154e_vars.slotOffset);
-    ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
+    schedule_syncAsn(&ieee154e_vars.asn);
     /*
     infer the asnOffset based on the fact that
     ieee154e_vars.freq = 11 + (asnOffset + channelOffset)%16
@@ -2550,7 +2527,7 @@ port_INLINE void ieee154e_syncSlotOffset(void) {
     ieee154e_vars.asnOffset = i - schedule_getChannelOffset();
 }
 
-uint16_t ieee154e_getSlotDuration(void) {
+PORT_TIMER_WIDTH ieee154e_getSlotDuration(void) {
     return ieee154e_vars.slotDuration;
 }
 
@@ -2595,7 +2572,7 @@ void synchronizePacket(PORT_TIMER_WIDTH timeReceived) {
     if ((PORT_SIGNED_INT_WIDTH) newPeriod - (PORT_SIGNED_INT_WIDTH) currentValue <
         (PORT_SIGNED_INT_WIDTH) RESYNCHRONIZATIONGUARD) {
         newPeriod += TsSlotDuration;
-        incrementAsnOffset();
+        incrementAsnOffset(1);
     }
 
     // resynchronize by applying the new period
@@ -2691,6 +2668,9 @@ void synchronizeAck(PORT_SIGNED_INT_WIDTH timeCorrection) {
 void changeIsSync(bool newIsSync) {
     ieee154e_vars.isSync = newIsSync;
 
+    // slots skipped under the previous synchronization state must not be added to the ASN
+    ieee154e_vars.numOfSleepSlots = 1;
+
     if (ieee154e_vars.isSync == TRUE) {
         leds_sync_on();
         resetStats();
@@ -2892,7 +2872,7 @@ void endSlot(void) {
             notif_sendDone(ieee154e_vars.dataToSend, E_FAIL);
         } else {
             // return packet to the virtual COMPONENT_SIXTOP_TO_IEEE802154E component
-            ieee154e_vars.dataToSend->owner = COMPONENT_SIXTOP_TO_IEEE802154E;
+            openqueue_macPutPacket(ieee154e_vars.dataToSend);
         }
 
         // reset local variable
@@ -2991,6 +2971,100 @@ void endSlot(void) {
     if (DURATION_si + ieee154e_vars.startOfSlotReference - opentimers_getValue() < ieee154e_vars.slotDuration) {
         openserial_inhibitStop(); // end of slot
     }
+
+    // use the time until the next active slot to secure the frame it will send
+    prepareNextTx();
+}
+
+/**
+\brief Point txFrame to the frame of dataToSend, secured for the current ASN.
+
+An unsecured frame is loaded in the radio straight from its queue entry. A
+secured one is written to securedFrame, so the entry stays in clear for the
+retransmissions, unless prepareNextTx() already did it for this ASN. Either
+way the 2 CRC bytes are only counted in txFrameLength.
+
+\returns E_SUCCESS when txFrame is ready, E_FAIL if the frame could not be
+    secured, kept for a later retry, or is too long, dropped by endSlot().
+*/
+owerror_t loadTxFrame(void) {
+    OpenQueueEntry_t *msg;
+
+    msg = ieee154e_vars.dataToSend;
+
+    if (msg->l2_securityLevel == IEEE154_ASH_SLF_TYPE_NOSEC) {
+        ieee154e_vars.txFrame = msg->payload;
+        ieee154e_vars.txFrameLength = msg->length + LENGTH_CRC;
+    } else {
+        if (
+                ieee154e_vars.preparedFrame != msg ||
+                memcmp(&ieee154e_vars.preparedAsn, &ieee154e_vars.asn, sizeof(asn_t)) != 0
+                ) {
+            ieee154e_vars.preparedFrame = NULL;
+            if (IEEE802154_security_outgoingFrameSecurity(msg, &ieee154e_vars.asn, ieee154e_vars.securedFrame) !=
+                E_SUCCESS) {
+                // keep the frame in the OpenQueue in order to retry later
+                return E_FAIL;
+            }
+        }
+        // secured ahead of the slot or just now, consumed by this slot
+        ieee154e_vars.preparedFrame = NULL;
+        ieee154e_vars.txFrame = ieee154e_vars.securedFrame;
+        ieee154e_vars.txFrameLength = msg->length + msg->l2_authenticationLength + LENGTH_CRC;
+    }
+
+    if (ieee154e_vars.txFrameLength > IEEE802154_FRAME_SIZE) {
+        // packet too big, will never successfully be transmitted, drop immediately
+        LOG_ERROR(COMPONENT_IEEE802154E, ERR_PACKET_TOO_LONG,
+                  (errorparameter_t) ieee154e_vars.txFrameLength,
+                  (errorparameter_t) 0);
+        // set retries to 1, so after it get decremented in endSlot, we drop the packet
+        msg->l2_retriesLeft = 1;
+        return E_FAIL;
+    }
+    return E_SUCCESS;
+}
+
+/**
+\brief Secure the frame of the next TX cell ahead of its slot.
+
+The nonce only depends on our address and the ASN, so the frame the next TX
+cell will pick is secured for that cell's ASN into securedFrame,
+leaving only its loading to the slot. The slot secures the frame itself when it
+picks another one, or sends it in another slot, e.g. a retry after a backoff.
+EBs are left to the slot, which fills in their ASN.
+*/
+void prepareNextTx(void) {
+    open_addr_t neighbor;
+    asn_t asn;
+    OpenQueueEntry_t *frame;
+
+    if (ieee154e_vars.isSync == FALSE || schedule_getNextTxCell(&neighbor, &asn) == FALSE) {
+        return;
+    }
+
+    // the frame the next TX cell will pick, as in activity_ti1ORri1()
+    if (packetfunctions_isBroadcastMulticast(&neighbor) == FALSE) {
+        frame = openqueue_macGetUnicastPacket(&neighbor);
+        if (frame == NULL) {
+            frame = openqueue_macGetKaPacket(&neighbor);
+        }
+    } else {
+        frame = openqueue_macGetDIOPacket();
+    }
+    if (frame == NULL || frame->l2_securityLevel == IEEE154_ASH_SLF_TYPE_NOSEC) {
+        return;
+    }
+    if (frame == ieee154e_vars.preparedFrame && memcmp(&asn, &ieee154e_vars.preparedAsn, sizeof(asn_t)) == 0) {
+        // already secured for that slot
+        return;
+    }
+
+    ieee154e_vars.preparedFrame = NULL;
+    if (IEEE802154_security_outgoingFrameSecurity(frame, &asn, ieee154e_vars.securedFrame) == E_SUCCESS) {
+        ieee154e_vars.preparedFrame = frame;
+        memcpy(&ieee154e_vars.preparedAsn, &asn, sizeof(asn_t));
+    }
 }
 
 bool ieee154e_isSynch(void) {
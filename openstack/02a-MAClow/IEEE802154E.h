@@ -253,10 +253,13 @@ typedef struct {
     // misc
     asn_t asn;                                      // current absolute slot number
     slotOffset_t slotOffset;                        // current slot offset
-    slotOffset_t nextActiveSlotOffset;              // next active slot offset
     PORT_TIMER_WIDTH deSyncTimeout;                 // how many slots left before looses sync
     bool isSync;                                    // TRUE iff mote is synchronized to network
-    OpenQueueEntry_t localCopyForTransmission;      // copy of the frame used for current TX
+    uint8_t *txFrame;                               // frame of the current TX as loaded in the radio, CRC included
+    uint16_t txFrameLength;                         // length of txFrame
+    uint8_t securedFrame[IEEE802154_FRAME_SIZE];    // secured copy of the frame to send, its queue entry stays in clear
+    OpenQueueEntry_t *preparedFrame;                // frame secured ahead of its slot in securedFrame, NULL if none
+    asn_t preparedAsn;                              // ASN of the slot preparedFrame was secured for
     PORT_TIMER_WIDTH numOfSleepSlots;               // number of slots to sleep between active slots
     // as shown on the chronogram
     ieee154e_state_t state;                         // state of the FSM
@@ -286,7 +289,7 @@ typedef struct {
     // time correction
     int16_t timeCorrection;                         // store the timeCorrection, prepend and retrieve it inside of frame header
 
-    uint16_t slotDuration;                          // duration of slot
+    PORT_TIMER_WIDTH slotDuration;                  // duration of slot, spans the skipped slots when slot skipping
     opentimers_id_t timerId;                        // id of timer used for implementing TSCH slot FSM
     uint32_t startOfSlotReference;                  // the time refer to the beginning of slot
     opentimers_id_t serialInhibitTimerId;           // id of serial inhibit timer used for scheduling serial output
@@ -337,12 +340,14 @@ bool ieee154e_isSynch(void);
 
 void ieee154e_getAsn(uint8_t *array);
 
-uint16_t ieee154e_getSlotDuration(void);
+PORT_TIMER_WIDTH ieee154e_getSlotDuration(void);
 
 uint16_t ieee154e_getTimeCorrection(void);
 
 void ieee154e_getTicsInfo(uint32_t *numTicsOn, uint32_t *numTicsTotal);
 
+void ieee154e_invalidatePreparedFrame(OpenQueueEntry_t *pkt);
+
 // events
 void ieee154e_startOfFrame(PORT_TIMER_WIDTH capturedTime);
 
@@ -43,11 +43,11 @@ void IEEE802154_security_init(void) {
 
     // invalidate beacon key (key 1)
     ieee802154_security_vars.k1.index = IEEE802154_SECURITY_KEYINDEX_INVALID;
-    memset(&ieee802154_security_vars.k1.value[0], 0x00, 16);
+    memset(&ieee802154_security_vars.k1.key, 0x00, sizeof(aes128_key_t));
 
     // invalidate data key (key 2)
     ieee802154_security_vars.k2.index = IEEE802154_SECURITY_KEYINDEX_INVALID;
-    memset(&ieee802154_security_vars.k2.value[0], 0x00, 16);
+    memset(&ieee802154_security_vars.k2.key, 0x00, sizeof(aes128_key_t));
 }
 
 uint8_t IEEE802154_security_getBeaconKeyIndex(void) {
@@ -60,12 +60,15 @@ uint8_t IEEE802154_security_getDataKeyIndex(void) {
 
 void IEEE802154_security_setBeaconKey(uint8_t index, uint8_t *value) {
     ieee802154_security_vars.k1.index = index;
-    memcpy(ieee802154_security_vars.k1.value, value, 16);
+    aes128_key_init(&ieee802154_security_vars.k1.key, value);
+    // a frame secured ahead of its slot used the previous key
+    ieee154e_invalidatePreparedFrame(NULL);
 }
 
 void IEEE802154_security_setDataKey(uint8_t index, uint8_t *value) {
     ieee802154_security_vars.k2.index = index;
-    memcpy(ieee802154_security_vars.k2.value, value, 16);
+    aes128_key_init(&ieee802154_security_vars.k2.key, value);
+    ieee154e_invalidatePreparedFrame(NULL);
 }
 
 bool IEEE802154_security_isConfigured(void) {
@@ -128,7 +131,7 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
         case IEEE154_ASH_KEYIDMODE_DEFAULTKEYSOURCE: // macDefaultKeySource
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_16: // keySource with 16b address
-            temp_keySource = &msg->l2_keySource;
+            temp_keySource = idmanager_getMyID(ADDR_64B);
             if (packetfunctions_reserveHeader(&msg, sizeof(uint8_t)) == E_FAIL) {
                 return E_FAIL;
             }
@@ -139,7 +142,7 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
             *((uint8_t * )(msg->payload)) = temp_keySource->addr_64b[7];
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_64: // keySource with 64b address
-            temp_keySource = &msg->l2_keySource;
+            temp_keySource = idmanager_getMyID(ADDR_64B);
             if (packetfunctions_writeAddress(&msg, temp_keySource, OW_LITTLE_ENDIAN) == E_FAIL) {
                 return E_FAIL;
             }
@@ -169,42 +172,51 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
 
 /**
 \brief Key searching and encryption/authentication operations.
+
+\param[in,out] msg The frame to secure.
+\param[in] asn The ASN of the slot the frame is sent in, part of the nonce.
+\param[out] frame Where the secured frame is written, followed by its MIC. msg->payload secures
+    the frame in place, extending msg with the MIC; otherwise msg is left in clear and the secured
+    frame is msg->length + msg->l2_authenticationLength long.
 */
-owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
+owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg, asn_t *asn, uint8_t *frame) {
     uint8_t nonce[13];
-    uint8_t *key;
+    aes128_key_t *key;
     owerror_t outStatus;
     uint8_t *a;
     uint8_t len_a;
     uint8_t *m;
     uint8_t len_m;
 
-    key = msg->l2_frameType == IEEE154_TYPE_BEACON ? ieee802154_security_vars.k1.value
-                                                   : ieee802154_security_vars.k2.value;
+    key = msg->l2_frameType == IEEE154_TYPE_BEACON ? &ieee802154_security_vars.k1.key
+                                                   : &ieee802154_security_vars.k2.key;
 
     // First 8 bytes of the nonce are always the source address of the frame
     memcpy(&nonce[0], idmanager_getMyID(ADDR_64B)->addr_64b, 8);
 
-    // Fill last 5 bytes with the ASN part of the nonce
-    ieee154e_getAsn(&nonce[8]);
-    packetfunctions_reverseArrayByteOrder(&nonce[8], 5);  // reverse ASN bytes to big endian
+    // Fill last 5 bytes with the ASN part of the nonce, in big endian
+    nonce[8] = asn->byte4;
+    nonce[9] = (uint8_t) (asn->bytes2and3 >> 8);
+    nonce[10] = (uint8_t) (asn->bytes2and3 & 0xff);
+    nonce[11] = (uint8_t) (asn->bytes0and1 >> 8);
+    nonce[12] = (uint8_t) (asn->bytes0and1 & 0xff);
 
     // identify data to be authenticated and data to be encrypted
     switch (msg->l2_securityLevel) {
         case IEEE154_ASH_SLF_TYPE_MIC_32:  // authentication only cases
         case IEEE154_ASH_SLF_TYPE_MIC_64:
         case IEEE154_ASH_SLF_TYPE_MIC_128:
-            a = msg->payload;             // first byte of the frame
+            a = frame;                    // first byte of the frame
             len_a = msg->length;          // whole frame
-            m = &msg->payload[len_a];     // concatenate MIC at the end of the frame
+            m = &frame[len_a];            // concatenate MIC at the end of the frame
             len_m = 0;                    // length of the encrypted part
             break;
         case IEEE154_ASH_SLF_TYPE_ENC_MIC_32:  // authentication + encryption cases
         case IEEE154_ASH_SLF_TYPE_ENC_MIC_64:
         case IEEE154_ASH_SLF_TYPE_ENC_MIC_128:
-            a = msg->payload;             // first byte of the frame
-            m = msg->l2_payload;          // first byte where we should start encrypting (see 15.4 std)
-            len_a = m - a;                // part that is only authenticated is the difference of two pointers
+            a = frame;                    // first byte of the frame
+            len_a = msg->l2_payload - msg->payload; // part that is only authenticated, up to the l2 payload
+            m = &frame[len_a];            // first byte where we should start encrypting (see 15.4 std)
             len_m = msg->length - len_a;  // part that is encrypted+authenticated is the rest of the frame
             break;
         case IEEE154_ASH_SLF_TYPE_ENC:    // encryption only
@@ -221,7 +233,13 @@ owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
         return E_FAIL;
     }
 
-    if (msg->l2_authenticationLength != 0) {
+    if (frame != msg->payload) {
+        // secure a copy, with room for the MIC and the CRC
+        if (len_a + len_m + msg->l2_authenticationLength + LENGTH_CRC > IEEE802154_FRAME_SIZE) {
+            return E_FAIL;
+        }
+        memcpy(frame, msg->payload, msg->length);
+    } else if (msg->l2_authenticationLength != 0) {
         // update the length of the packet
         if (packetfunctions_reserveFooter(&msg, msg->l2_authenticationLength) == E_FAIL) {
             return E_FAIL;
@@ -258,6 +276,7 @@ void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg,
     uint8_t i;
     uint8_t receivedASN[5];
     macFrameCounter_t l2_frameCounter;
+    open_addr_t keySource;             // only parsed, the key is selected by its index
 
     // retrieve the Security Control field
     // 1byte, Security Control Field
@@ -309,19 +328,18 @@ void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg,
         case IEEE154_ASH_KEYIDMODE_IMPLICIT:
         case IEEE154_ASH_KEYIDMODE_DEFAULTKEYSOURCE:
             //key is derived implicitly
-            memcpy(&(msg->l2_keySource), &tempheader->src, sizeof(open_addr_t));
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_16:
             packetfunctions_readAddress(((uint8_t * )(msg->payload) + tempheader->headerLength),
                                         ADDR_16B,
-                                        &msg->l2_keySource,
+                                        &keySource,
                                         OW_LITTLE_ENDIAN);
             tempheader->headerLength += 2;
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_64:
             packetfunctions_readAddress(((uint8_t * )(msg->payload) + tempheader->headerLength),
                                         ADDR_64B,
-                                        &msg->l2_keySource,
+                                        &keySource,
                                         OW_LITTLE_ENDIAN);
             tempheader->headerLength += 8;
             break;
@@ -351,10 +369,10 @@ owerror_t IEEE802154_security_incomingFrame(OpenQueueEntry_t *msg) {
     uint8_t len_a;
     uint8_t *c;
     uint8_t len_c;
-    uint8_t *key;
+    aes128_key_t *key;
 
-    key = msg->l2_frameType == IEEE154_TYPE_BEACON ? ieee802154_security_vars.k1.value
-                                                   : ieee802154_security_vars.k2.value;
+    key = msg->l2_frameType == IEEE154_TYPE_BEACON ? &ieee802154_security_vars.k1.key
+                                                   : &ieee802154_security_vars.k2.key;
 
     // First 8 bytes of the nonce are always the source address of the frame
     memcpy(&nonce[0], msg->l2_nextORpreviousHop.addr_64b, 8);
@@ -553,7 +571,10 @@ void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg,
     return;
 }
 
-owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
+owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg, asn_t *asn, uint8_t *frame) {
+    if (frame != msg->payload) {
+        memcpy(frame, msg->payload, msg->length);
+    }
     return E_SUCCESS;
 }
 
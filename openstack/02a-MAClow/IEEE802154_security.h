@@ -21,6 +21,7 @@
 #include "config.h"
 #include "opendefs.h"
 #include "IEEE802154.h"
+#include "aes128.h"
 
 //=========================== define ==========================================
 
@@ -51,7 +52,7 @@
 
 typedef struct {
     uint8_t index;
-    uint8_t value[16];
+    aes128_key_t key;           // expanded when the key is set, not for every frame
 } symmetric_key_802154_t;
 
 //=========================== variables =======================================
@@ -71,7 +72,7 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
 
 void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader);
 
-owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg);
+owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg, asn_t *asn, uint8_t *frame);
 
 owerror_t IEEE802154_security_incomingFrame(OpenQueueEntry_t *msg);
 
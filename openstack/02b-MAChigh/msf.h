@@ -36,6 +36,7 @@
 #endif
 
 #define HOUSEKEEPING_PERIOD           5000 // miliseconds
+#define HOUSEKEEPING_SLACK            1000 // miliseconds
 #define QUARANTINE_DURATION            300 // seconds
 #define WAITDURATION_MIN             30000 // miliseconds
 #define WAITDURATION_RANDOM_RANGE    30000 // miliseconds
@@ -7,6 +7,7 @@
 #include "IEEE802154E.h"
 #include "openrandom.h"
 #include "msf.h"
+#include "routingtable.h"
 
 //=========================== variables =======================================
 
@@ -27,7 +28,17 @@ bool isNeighbor(open_addr_t *neighbor);
 
 void removeNeighbor(uint8_t neighborIndex);
 
-bool isThisRowMatching(open_addr_t *address, uint8_t rowNumber);
+uint8_t getNeighborRow(open_addr_t *address);
+
+uint8_t lookupNeighborRow(open_addr_t *address);
+
+uint8_t hashNeighborAddress(open_addr_t *address);
+
+void indexNeighborRow(uint8_t rowNumber);
+
+void dropNeighborRowIndex(uint8_t rowNumber);
+
+void updateNeighborEtx(uint8_t rowNumber, uint16_t sample);
 
 //=========================== public ==========================================
 
@@ -38,6 +49,7 @@ void neighbors_init(void) {
     // clear module variables
     memset(&neighbors_vars, 0, sizeof(neighbors_vars_t));
     // The .used fields get reset to FALSE by this memset.
+    memset(&neighbors_vars.rowIndex[0], NEIGHBORS_HASH_EMPTY, sizeof(neighbors_vars.rowIndex));
 }
 
 //===== getters
@@ -72,6 +84,38 @@ uint8_t neighbors_getNumTx(uint8_t index) {
     return neighbors_vars.neighbors[index].numTx;
 }
 
+/**
+\brief Retrieve the estimated ETX of the link to a neighbor.
+
+\param[in] index The index of that neighbor in the neighbor table.
+
+\returns The ETX, in units of 1/NEIGHBORS_ETX_SCALE, DEFAULTLINKCOST if no
+   transmission to that neighbor was accounted for yet.
+*/
+uint16_t neighbors_getEtx(uint8_t index) {
+    neighborEtx_t *etx;
+
+    etx = &neighbors_vars.etx[index];
+    if (etx->numSamples == 0) {
+        return DEFAULTLINKCOST * NEIGHBORS_ETX_SCALE;
+    }
+    if (etx->numSamples < NEIGHBORS_ETX_MIN_SAMPLES || etx->fastEtx > etx->slowEtx) {
+        return etx->fastEtx;
+    }
+    return etx->slowEtx;
+}
+
+/**
+\brief Retrieve the number of ETX samples taken on the link to a neighbor.
+
+\param[in] index The index of that neighbor in the neighbor table.
+
+\returns The number of samples, saturating at 0xff.
+*/
+uint8_t neighbors_getEtxConfidence(uint8_t index) {
+    return neighbors_vars.etx[index].numSamples;
+}
+
 /**
 \brief Find neighbor to which to send KA.
 
@@ -138,13 +182,23 @@ bool neighbors_getNeighborNoResource(uint8_t index) {
 
 uint8_t neighbors_getSequenceNumber(open_addr_t *address) {
     uint8_t i;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            break;
-        }
+
+    i = lookupNeighborRow(address);
+    if (i == MAXNUMNEIGHBORS) {
+        return 0;
     }
     return neighbors_vars.neighbors[i].sequenceNumber;
+}
+
+/**
+\brief Retrieve the index of a neighbor in the neighbor table.
+
+\param[in] address The 64-bit address of the neighbor.
 
+\returns The index of that neighbor, MAXNUMNEIGHBORS if it is not in the table.
+*/
+uint8_t neighbors_getNeighborIndex(open_addr_t *address) {
+    return lookupNeighborRow(address);
 }
 
 //===== interrogators
@@ -177,12 +231,10 @@ bool neighbors_isStableNeighbor(open_addr_t *address) {
             return returnVal;
     }
 
-    // iterate through neighbor table
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (isThisRowMatching(&temp_addr_64b, i) && neighbors_vars.neighbors[i].stableNeighbor == TRUE) {
-            returnVal = TRUE;
-            break;
-        }
+    // look up the neighbor table
+    i = lookupNeighborRow(&temp_addr_64b);
+    if (i < MAXNUMNEIGHBORS && neighbors_vars.neighbors[i].stableNeighbor == TRUE) {
+        returnVal = TRUE;
     }
 
     return returnVal;
@@ -224,12 +276,10 @@ bool neighbors_isInsecureNeighbor(open_addr_t *address) {
             return returnVal;
     }
 
-    // iterate through neighbor table
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (isThisRowMatching(address, i)) {
-            returnVal = neighbors_vars.neighbors[i].insecure;
-            break;
-        }
+    // look up the neighbor table
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        returnVal = neighbors_vars.neighbors[i].insecure;
     }
 
     return returnVal;
@@ -258,7 +308,10 @@ bool neighbors_isNeighborWithHigherDAGrank(uint8_t index) {
 bool neighbors_reachedMinimalTransmission(uint8_t index) {
     bool returnVal;
 
-    if (neighbors_vars.neighbors[index].used == TRUE && neighbors_vars.neighbors[index].numTx > MINIMAL_NUM_TX) {
+    if (
+            neighbors_vars.neighbors[index].used == TRUE &&
+            neighbors_vars.etx[index].numSamples >= NEIGHBORS_ETX_MIN_SAMPLES
+            ) {
         returnVal = TRUE;
     } else {
         returnVal = FALSE;
@@ -297,60 +350,50 @@ void neighbors_indicateRx(open_addr_t *l2_src,
                           uint8_t joinPrio,
                           bool insecure) {
     uint8_t i;
-    bool newNeighbor;
 
-    // update existing neighbor
-    newNeighbor = TRUE;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (isThisRowMatching(l2_src, i)) {
+    i = getNeighborRow(l2_src);
+    if (i == MAXNUMNEIGHBORS) {
+        // register new neighbor
+        registerNewNeighbor(l2_src, rssi, asnTs, joinPrioPresent, joinPrio, insecure);
+        return;
+    }
 
-            // this is not a new neighbor
-            newNeighbor = FALSE;
+    // whether the neighbor is considered as secure or not
+    neighbors_vars.neighbors[i].insecure = insecure;
 
-            // whether the neighbor is considered as secure or not
-            neighbors_vars.neighbors[i].insecure = insecure;
+    // update numRx, rssi, asn
+    neighbors_vars.neighbors[i].numRx++;
+    neighbors_vars.neighbors[i].rssi = rssi;
+    memcpy(&neighbors_vars.neighbors[i].asn, asnTs, sizeof(asn_t));
+    //update jp
+    if (joinPrioPresent == TRUE) {
+        neighbors_vars.neighbors[i].joinPrio = joinPrio;
+    }
 
-            // update numRx, rssi, asn
-            neighbors_vars.neighbors[i].numRx++;
-            neighbors_vars.neighbors[i].rssi = rssi;
-            memcpy(&neighbors_vars.neighbors[i].asn, asnTs, sizeof(asn_t));
-            //update jp
-            if (joinPrioPresent == TRUE) {
-                neighbors_vars.neighbors[i].joinPrio = joinPrio;
+    // update stableNeighbor, switchStabilityCounter
+    if (neighbors_vars.neighbors[i].stableNeighbor == FALSE) {
+        if (neighbors_vars.neighbors[i].rssi > BADNEIGHBORMAXRSSI) {
+            neighbors_vars.neighbors[i].switchStabilityCounter++;
+            if (neighbors_vars.neighbors[i].switchStabilityCounter >= SWITCHSTABILITYTHRESHOLD) {
+                neighbors_vars.neighbors[i].switchStabilityCounter = 0;
+                neighbors_vars.neighbors[i].stableNeighbor = TRUE;
+                icmpv6rpl_updateCandidateParent(i);
             }
-
-            // update stableNeighbor, switchStabilityCounter
-            if (neighbors_vars.neighbors[i].stableNeighbor == FALSE) {
-                if (neighbors_vars.neighbors[i].rssi > BADNEIGHBORMAXRSSI) {
-                    neighbors_vars.neighbors[i].switchStabilityCounter++;
-                    if (neighbors_vars.neighbors[i].switchStabilityCounter >= SWITCHSTABILITYTHRESHOLD) {
-                        neighbors_vars.neighbors[i].switchStabilityCounter = 0;
-                        neighbors_vars.neighbors[i].stableNeighbor = TRUE;
-                    }
-                } else {
-                    neighbors_vars.neighbors[i].switchStabilityCounter = 0;
-                }
-            } else if (neighbors_vars.neighbors[i].stableNeighbor == TRUE) {
-                if (neighbors_vars.neighbors[i].rssi < GOODNEIGHBORMINRSSI) {
-                    neighbors_vars.neighbors[i].switchStabilityCounter++;
-                    if (neighbors_vars.neighbors[i].switchStabilityCounter >= SWITCHSTABILITYTHRESHOLD) {
-                        neighbors_vars.neighbors[i].switchStabilityCounter = 0;
-                        neighbors_vars.neighbors[i].stableNeighbor = FALSE;
-                    }
-                } else {
-                    neighbors_vars.neighbors[i].switchStabilityCounter = 0;
-                }
+        } else {
+            neighbors_vars.neighbors[i].switchStabilityCounter = 0;
+        }
+    } else if (neighbors_vars.neighbors[i].stableNeighbor == TRUE) {
+        if (neighbors_vars.neighbors[i].rssi < GOODNEIGHBORMINRSSI) {
+            neighbors_vars.neighbors[i].switchStabilityCounter++;
+            if (neighbors_vars.neighbors[i].switchStabilityCounter >= SWITCHSTABILITYTHRESHOLD) {
+                neighbors_vars.neighbors[i].switchStabilityCounter = 0;
+                neighbors_vars.neighbors[i].stableNeighbor = FALSE;
+                icmpv6rpl_updateCandidateParent(i);
             }
-
-            // stop looping
-            break;
+        } else {
+            neighbors_vars.neighbors[i].switchStabilityCounter = 0;
         }
     }
-
-    // register new neighbor
-    if (newNeighbor == TRUE) {
-        registerNewNeighbor(l2_src, rssi, asnTs, joinPrioPresent, joinPrio, insecure);
-    }
 }
 
 /**
@@ -384,63 +427,66 @@ void neighbors_indicateTx(
         return;
     }
 
-    // loop through neighbor table
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (isThisRowMatching(l2_dest, i)) {
-            // found the target neighbor
+    // look up the neighbor table
+    i = getNeighborRow(l2_dest);
+    if (i == MAXNUMNEIGHBORS) {
+        return;
+    }
 
-            // reset backoff variable
-            neighbors_vars.neighbors[i].backoffExponenton = MINBE - 1;
-            neighbors_vars.neighbors[i].backoff = 0;
+    // reset backoff variable
+    neighbors_vars.neighbors[i].backoffExponenton = MINBE - 1;
+    neighbors_vars.neighbors[i].backoff = 0;
 
-            // update asn if ack'ed
-            if (was_finally_acked == TRUE) {
-                memcpy(&neighbors_vars.neighbors[i].asn, asnTs, sizeof(asn_t));
-            }
+    // update asn if ack'ed
+    if (was_finally_acked == TRUE) {
+        memcpy(&neighbors_vars.neighbors[i].asn, asnTs, sizeof(asn_t));
+    }
 
-            // only update numTx/numTxAck on Tx cell
-            if (sentOnTxCell) {
-                if (neighbors_vars.neighbors[i].numTx > (0xff - numTxAttempts)) {
-                    neighbors_vars.neighbors[i].numWraps++; //counting the number of times that tx wraps.
-                    neighbors_vars.neighbors[i].numTx /= 2;
-                    neighbors_vars.neighbors[i].numTxACK /= 2;
-                }
-                // update statistics
-                neighbors_vars.neighbors[i].numTx += numTxAttempts;
+    // only update numTx/numTxAck on Tx cell
+    if (sentOnTxCell) {
+        if (neighbors_vars.neighbors[i].numTx > (0xff - numTxAttempts)) {
+            neighbors_vars.neighbors[i].numWraps++; //counting the number of times that tx wraps.
+            neighbors_vars.neighbors[i].numTx /= 2;
+            neighbors_vars.neighbors[i].numTxACK /= 2;
+        }
+        // update statistics
+        neighbors_vars.neighbors[i].numTx += numTxAttempts;
 
-                if (was_finally_acked == TRUE) {
-                    neighbors_vars.neighbors[i].numTxACK++;
-                }
+        if (was_finally_acked == TRUE) {
+            neighbors_vars.neighbors[i].numTxACK++;
+        }
 
-                // numTx and numTxAck changed,, update my rank
-                icmpv6rpl_updateMyDAGrankAndParentSelection();
-            }
-            break;
+        // feed the ETX estimator
+        if (was_finally_acked == TRUE) {
+            updateNeighborEtx(i, numTxAttempts);
+        } else {
+            updateNeighborEtx(i, NEIGHBORS_ETX_NOACK_PENALTY);
         }
+
+        // numTx and numTxAck changed,, update my rank
+        icmpv6rpl_indicateNeighborUpdate(i);
     }
 }
 
 void neighbors_updateSequenceNumber(open_addr_t *address) {
     uint8_t i;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            neighbors_vars.neighbors[i].sequenceNumber = (neighbors_vars.neighbors[i].sequenceNumber + 1) & 0xFF;
-            // rollover from 0xff to 0x01
-            if (neighbors_vars.neighbors[i].sequenceNumber == 0) {
-                neighbors_vars.neighbors[i].sequenceNumber = 1;
-            }
-            break;
+
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        neighbors_vars.neighbors[i].sequenceNumber = (neighbors_vars.neighbors[i].sequenceNumber + 1) & 0xFF;
+        // rollover from 0xff to 0x01
+        if (neighbors_vars.neighbors[i].sequenceNumber == 0) {
+            neighbors_vars.neighbors[i].sequenceNumber = 1;
         }
     }
 }
 
 void neighbors_resetSequenceNumber(open_addr_t *address) {
     uint8_t i;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            neighbors_vars.neighbors[i].sequenceNumber = 0;
-            break;
-        }
+
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        neighbors_vars.neighbors[i].sequenceNumber = 0;
     }
 }
 
@@ -470,29 +516,25 @@ bool neighbors_getNeighborEui64(open_addr_t *address, uint8_t addr_type, uint8_t
 // ==== update backoff
 void neighbors_updateBackoff(open_addr_t *address) {
     uint8_t i;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            // increase the backoffExponent
-            if (neighbors_vars.neighbors[i].backoffExponenton < MAXBE) {
-                neighbors_vars.neighbors[i].backoffExponenton++;
-            }
-            // set the backoff to a random value in [0..2^BE]
-            neighbors_vars.neighbors[i].backoff =
-                    openrandom_get16b() % (1 << neighbors_vars.neighbors[i].backoffExponenton);
-            break;
+
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        // increase the backoffExponent
+        if (neighbors_vars.neighbors[i].backoffExponenton < MAXBE) {
+            neighbors_vars.neighbors[i].backoffExponenton++;
         }
+        // set the backoff to a random value in [0..2^BE]
+        neighbors_vars.neighbors[i].backoff =
+                openrandom_get16b() % (1 << neighbors_vars.neighbors[i].backoffExponenton);
     }
 }
 
 void neighbors_decreaseBackoff(open_addr_t *address) {
     uint8_t i;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            if (neighbors_vars.neighbors[i].backoff > 0) {
-                neighbors_vars.neighbors[i].backoff--;
-            }
-            break;
-        }
+
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS && neighbors_vars.neighbors[i].backoff > 0) {
+        neighbors_vars.neighbors[i].backoff--;
     }
 }
 
@@ -501,13 +543,10 @@ bool neighbors_backoffHitZero(open_addr_t *address) {
     bool returnVal;
 
     returnVal = FALSE;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            returnVal = (neighbors_vars.neighbors[i].backoff == 0);
-            break;
-        }
-    }
-    if (i == MAXNUMNEIGHBORS) {
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        returnVal = (neighbors_vars.neighbors[i].backoff == 0);
+    } else {
         // The neighbor looking for is not in the table.
         // This is usually the case a packet is from downward traffic, which
         // doesn't need to be in the neighbor table.
@@ -522,12 +561,10 @@ bool neighbors_backoffHitZero(open_addr_t *address) {
 void neighbors_resetBackoff(open_addr_t *address) {
     uint8_t i;
 
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (packetfunctions_sameAddress(address, &neighbors_vars.neighbors[i].addr_64b)) {
-            neighbors_vars.neighbors[i].backoffExponenton = MINBE - 1;
-            neighbors_vars.neighbors[i].backoff = 0;
-            break;
-        }
+    i = lookupNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        neighbors_vars.neighbors[i].backoffExponenton = MINBE - 1;
+        neighbors_vars.neighbors[i].backoff = 0;
     }
 }
 
@@ -541,13 +578,11 @@ void neighbors_setNeighborRank(uint8_t index, dagrank_t rank) {
 void neighbors_setNeighborNoResource(open_addr_t *address) {
     uint8_t i;
 
-    // loop through neighbor table
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (isThisRowMatching(address, i)) {
-            neighbors_vars.neighbors[i].f6PNORES = TRUE;
-            icmpv6rpl_updateMyDAGrankAndParentSelection();
-            break;
-        }
+    // look up the neighbor table
+    i = getNeighborRow(address);
+    if (i < MAXNUMNEIGHBORS) {
+        neighbors_vars.neighbors[i].f6PNORES = TRUE;
+        icmpv6rpl_indicateNeighborUpdate(i);
     }
 }
 
@@ -556,48 +591,6 @@ void neighbors_setPreferredParent(uint8_t index, bool isPreferred) {
     neighbors_vars.neighbors[index].parentPreference = isPreferred;
 }
 
-//===== managing routing info
-
-/**
-\brief return the link cost to a neighbor, expressed as a rank increase from this neighbor to this node
-
-This really belongs to icmpv6rpl but it would require a much more complex interface to the neighbor table
-*/
-
-uint16_t neighbors_getLinkMetric(uint8_t index) {
-    uint16_t rankIncrease;
-    uint32_t rankIncreaseIntermediary; // stores intermediary results of rankIncrease calculation
-
-    // we assume that this neighbor has already been checked for being in use
-    // calculate link cost to this neighbor
-    if (neighbors_vars.neighbors[index].numTxACK == 0) {
-        if (neighbors_vars.neighbors[index].numTx > DEFAULTLINKCOST) {
-            if (neighbors_vars.neighbors[index].numTx < MINIMAL_NUM_TX) {
-                rankIncrease = (3 * neighbors_vars.neighbors[index].numTx - 2) * MINHOPRANKINCREASE;
-            } else {
-                rankIncrease = 65535;
-            }
-        } else {
-            rankIncrease = (3 * DEFAULTLINKCOST - 2) * MINHOPRANKINCREASE;
-        }
-    } else {
-        //6TiSCH minimal draft using OF0 for rank computation: ((3*numTx/numTxAck)-2)*minHopRankIncrease
-        // numTx is on 8 bits, so scaling up 10 bits won't lead to saturation
-        // but this <<10 followed by >>10 does not provide any benefit either. Result is the same.
-        rankIncreaseIntermediary = (((uint32_t) neighbors_vars.neighbors[index].numTx) << 10);
-        rankIncreaseIntermediary = (3 * rankIncreaseIntermediary * MINHOPRANKINCREASE) /
-                                   ((uint32_t) neighbors_vars.neighbors[index].numTxACK);
-        rankIncreaseIntermediary = rankIncreaseIntermediary - ((uint32_t)(2 * MINHOPRANKINCREASE) << 10);
-        // this could still overflow for numTx large and numTxAck small, Casting to 16 bits will yiel the least significant bits
-        if (rankIncreaseIntermediary >= (65536 << 10)) {
-            rankIncrease = 65535;
-        } else {
-            rankIncrease = (uint16_t)(rankIncreaseIntermediary >> 10);
-        }
-    }
-    return rankIncrease;
-}
-
 //===== maintenance
 
 void neighbors_removeOld(void) {
@@ -689,6 +682,7 @@ void registerNewNeighbor(open_addr_t *address,
                 neighbors_vars.neighbors[i].stableNeighbor = TRUE;
                 neighbors_vars.neighbors[i].switchStabilityCounter = 0;
                 memcpy(&neighbors_vars.neighbors[i].addr_64b, address, sizeof(open_addr_t));
+                indexNeighborRow(i);
                 neighbors_vars.neighbors[i].DAGrank = DEFAULTDAGRANK;
                 // since we don't have a DAG rank at this point, no need to call for routing table update
                 neighbors_vars.neighbors[i].rssi = rssi;
@@ -698,6 +692,7 @@ void registerNewNeighbor(open_addr_t *address,
                 memcpy(&neighbors_vars.neighbors[i].asn, asnTimestamp, sizeof(asn_t));
                 neighbors_vars.neighbors[i].backoffExponenton = MINBE - 1;;
                 neighbors_vars.neighbors[i].backoff = 0;
+                memset(&neighbors_vars.etx[i], 0, sizeof(neighborEtx_t));
                 //update jp
                 if (joinPrioPresent == TRUE) {
                     neighbors_vars.neighbors[i].joinPrio = joinPrio;
@@ -718,17 +713,13 @@ void registerNewNeighbor(open_addr_t *address,
 }
 
 bool isNeighbor(open_addr_t *neighbor) {
-    uint8_t i = 0;
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (isThisRowMatching(neighbor, i)) {
-            return TRUE;
-        }
-    }
-    return FALSE;
+    return getNeighborRow(neighbor) < MAXNUMNEIGHBORS;
 }
 
 void removeNeighbor(uint8_t neighborIndex) {
 
+    dropNeighborRowIndex(neighborIndex);
+
     neighbors_vars.neighbors[neighborIndex].used = FALSE;
     neighbors_vars.neighbors[neighborIndex].parentPreference = 0;
     neighbors_vars.neighbors[neighborIndex].stableNeighbor = FALSE;
@@ -746,19 +737,163 @@ void removeNeighbor(uint8_t neighborIndex) {
     neighbors_vars.neighbors[neighborIndex].backoffExponenton = MINBE - 1;
     neighbors_vars.neighbors[neighborIndex].backoff = 0;
     neighbors_vars.neighbors[neighborIndex].addr_64b.type = ADDR_NONE;
+    memset(&neighbors_vars.etx[neighborIndex], 0, sizeof(neighborEtx_t));
+
+    // this neighbor can't be a parent any more
+    icmpv6rpl_updateCandidateParent(neighborIndex);
+
+    // nor the next hop of my routes, before its row is reused
+    routingtable_removeNextHop(neighborIndex);
+}
+
+/**
+\brief Account for one ETX sample on the link to a neighbor.
+
+\param[in] rowNumber The row of that neighbor in the neighbor table.
+\param[in] sample    The number of transmissions the packet took, or
+   NEIGHBORS_ETX_NOACK_PENALTY if it was not ACK'ed.
+*/
+void updateNeighborEtx(uint8_t rowNumber, uint16_t sample) {
+    neighborEtx_t *etx;
+    uint32_t scaledSample;
+
+    etx = &neighbors_vars.etx[rowNumber];
+
+    if (sample > NEIGHBORS_ETX_NOACK_PENALTY) {
+        sample = NEIGHBORS_ETX_NOACK_PENALTY;
+    }
+    scaledSample = (uint32_t) sample * NEIGHBORS_ETX_SCALE;
+
+    if (etx->numSamples == 0) {
+        // first sample, it is the best estimate so far
+        etx->fastEtx = (uint16_t) scaledSample;
+        etx->slowEtx = (uint16_t) scaledSample;
+    } else {
+        etx->fastEtx = (uint16_t)(
+                (((uint32_t) etx->fastEtx << NEIGHBORS_ETX_FAST_SHIFT) - etx->fastEtx + scaledSample)
+                        >> NEIGHBORS_ETX_FAST_SHIFT
+        );
+        etx->slowEtx = (uint16_t)(
+                (((uint32_t) etx->slowEtx << NEIGHBORS_ETX_SLOW_SHIFT) - etx->slowEtx + scaledSample)
+                        >> NEIGHBORS_ETX_SLOW_SHIFT
+        );
+    }
+
+    if (etx->numSamples < 0xff) {
+        etx->numSamples++;
+    }
 }
 
 //=========================== helpers =========================================
 
-bool isThisRowMatching(open_addr_t *address, uint8_t rowNumber) {
+/**
+\brief Find the neighbor table row of some neighbor.
+
+\param[in] address The address of the neighbor, a 64-bit address.
+
+\returns The row of that neighbor, MAXNUMNEIGHBORS if it is not in the table.
+*/
+uint8_t getNeighborRow(open_addr_t *address) {
     switch (address->type) {
         case ADDR_64B:
-            return neighbors_vars.neighbors[rowNumber].used &&
-                   packetfunctions_sameAddress(address, &neighbors_vars.neighbors[rowNumber].addr_64b);
+            return lookupNeighborRow(address);
         default:
             LOG_CRITICAL(COMPONENT_NEIGHBORS, ERR_WRONG_ADDR_TYPE,
                          (errorparameter_t) address->type,
                          (errorparameter_t) 4);
-            return FALSE;
+            return MAXNUMNEIGHBORS;
+    }
+}
+
+/**
+\brief Find the neighbor table row of some address, probing the hash.
+
+Unlike getNeighborRow(), an address which is not a 64-bit address is silently
+reported as not in the table, as is the case for the anycast neighbor of a
+shared cell.
+
+\returns The row of that neighbor, MAXNUMNEIGHBORS if it is not in the table.
+*/
+uint8_t lookupNeighborRow(open_addr_t *address) {
+    uint8_t bucket;
+    uint8_t row;
+
+    if (address->type != ADDR_64B) {
+        return MAXNUMNEIGHBORS;
+    }
+
+    bucket = hashNeighborAddress(address);
+    while (neighbors_vars.rowIndex[bucket] != NEIGHBORS_HASH_EMPTY) {
+        row = neighbors_vars.rowIndex[bucket];
+        if (memcmp(address->addr_64b, neighbors_vars.neighbors[row].addr_64b.addr_64b, LENGTH_ADDR64b) == 0) {
+            return row;
+        }
+        bucket = (bucket + 1) & (NEIGHBORS_HASH_SIZE - 1);
+    }
+    return MAXNUMNEIGHBORS;
+}
+
+uint8_t hashNeighborAddress(open_addr_t *address) {
+    uint8_t i;
+    uint8_t hash;
+
+    hash = 0;
+    for (i = 0; i < LENGTH_ADDR64b; i++) {
+        hash = (uint8_t)((hash << 3) | (hash >> 5)) ^ address->addr_64b[i];
+    }
+    return hash & (NEIGHBORS_HASH_SIZE - 1);
+}
+
+/**
+\brief Index a newly used row under the hash of its address.
+*/
+void indexNeighborRow(uint8_t rowNumber) {
+    uint8_t bucket;
+
+    bucket = hashNeighborAddress(&neighbors_vars.neighbors[rowNumber].addr_64b);
+    while (neighbors_vars.rowIndex[bucket] != NEIGHBORS_HASH_EMPTY) {
+        bucket = (bucket + 1) & (NEIGHBORS_HASH_SIZE - 1);
+    }
+    neighbors_vars.rowIndex[bucket] = rowNumber;
+}
+
+/**
+\brief Remove a row from the hash, before its address is cleared.
+
+The following entries of the probe sequence are shifted back into the freed
+bucket when their own bucket allows it, so that lookups never need tombstones.
+*/
+void dropNeighborRowIndex(uint8_t rowNumber) {
+    uint8_t freeBucket;
+    uint8_t bucket;
+    uint8_t home;
+
+    if (neighbors_vars.neighbors[rowNumber].addr_64b.type != ADDR_64B) {
+        // this row is not indexed
+        return;
+    }
+
+    freeBucket = hashNeighborAddress(&neighbors_vars.neighbors[rowNumber].addr_64b);
+    while (neighbors_vars.rowIndex[freeBucket] != rowNumber) {
+        if (neighbors_vars.rowIndex[freeBucket] == NEIGHBORS_HASH_EMPTY) {
+            // this row is not indexed
+            return;
+        }
+        freeBucket = (freeBucket + 1) & (NEIGHBORS_HASH_SIZE - 1);
+    }
+
+    bucket = freeBucket;
+    while (TRUE) {
+        bucket = (bucket + 1) & (NEIGHBORS_HASH_SIZE - 1);
+        if (neighbors_vars.rowIndex[bucket] == NEIGHBORS_HASH_EMPTY) {
+            break;
+        }
+        home = hashNeighborAddress(&neighbors_vars.neighbors[neighbors_vars.rowIndex[bucket]].addr_64b);
+        // the entry can move back only if its home bucket is not cyclically in (freeBucket, bucket]
+        if (((bucket - home) & (NEIGHBORS_HASH_SIZE - 1)) >= ((bucket - freeBucket) & (NEIGHBORS_HASH_SIZE - 1))) {
+            neighbors_vars.rowIndex[freeBucket] = neighbors_vars.rowIndex[bucket];
+            freeBucket = bucket;
+        }
     }
+    neighbors_vars.rowIndex[freeBucket] = NEIGHBORS_HASH_EMPTY;
 }
@@ -27,6 +27,29 @@
 #endif
 #define MINIMAL_NUM_TX            16
 
+/**
+\brief Link ETX estimator.
+
+Every unicast transmission on a Tx cell gives an ETX sample: the number of
+attempts when it was ACK'ed, NEIGHBORS_ETX_NOACK_PENALTY otherwise. The samples
+feed two fixed-point EWMAs (1.0 is NEIGHBORS_ETX_SCALE): a fast one, weighting
+each sample 1/2^NEIGHBORS_ETX_FAST_SHIFT, and a slow one, weighting it
+1/2^NEIGHBORS_ETX_SLOW_SHIFT. The link ETX is the fast estimate until
+NEIGHBORS_ETX_MIN_SAMPLES samples were taken, then the larger of both, so that a
+link degrades quickly but recovers its cost slowly.
+*/
+#define NEIGHBORS_ETX_SCALE       128
+#ifndef NEIGHBORS_ETX_FAST_SHIFT
+#define NEIGHBORS_ETX_FAST_SHIFT  1
+#endif
+#ifndef NEIGHBORS_ETX_SLOW_SHIFT
+#define NEIGHBORS_ETX_SLOW_SHIFT  4
+#endif
+#ifndef NEIGHBORS_ETX_MIN_SAMPLES
+#define NEIGHBORS_ETX_MIN_SAMPLES 8
+#endif
+#define NEIGHBORS_ETX_NOACK_PENALTY MINIMAL_NUM_TX
+
 #define MAXDAGRANK                0xffff
 #define DEFAULTDAGRANK            MAXDAGRANK
 #define MINHOPRANKINCREASE        256  // default value in RPL and Minimal 6TiSCH draft
@@ -34,8 +57,41 @@
 
 #define DEFAULTJOINPRIORITY       0xff
 
+/**
+\brief Number of buckets of the hash from EUI-64 to neighbor table row.
+
+The hash is an open-addressing table of row indices, so a lookup by address
+costs a few probes rather than a scan of the MAXNUMNEIGHBORS rows. It must be a
+power of 2, at least twice MAXNUMNEIGHBORS to keep the probe sequences short.
+*/
+#ifndef NEIGHBORS_HASH_SIZE
+#if MAXNUMNEIGHBORS <= 16
+#define NEIGHBORS_HASH_SIZE       32
+#elif MAXNUMNEIGHBORS <= 32
+#define NEIGHBORS_HASH_SIZE       64
+#else
+#define NEIGHBORS_HASH_SIZE       128
+#endif
+#endif
+
+#if (NEIGHBORS_HASH_SIZE & (NEIGHBORS_HASH_SIZE - 1)) != 0 || NEIGHBORS_HASH_SIZE > 0x80
+#error "NEIGHBORS_HASH_SIZE must be a power of 2, at most 128"
+#endif
+
+#if NEIGHBORS_HASH_SIZE < 2 * MAXNUMNEIGHBORS
+#error "NEIGHBORS_HASH_SIZE must be at least twice MAXNUMNEIGHBORS"
+#endif
+
+#define NEIGHBORS_HASH_EMPTY      0xff
+
 //=========================== typedef =========================================
 
+typedef struct {
+    uint16_t fastEtx;         // fast EWMA of the ETX samples, NEIGHBORS_ETX_SCALE is 1.0
+    uint16_t slowEtx;         // slow EWMA of the ETX samples, NEIGHBORS_ETX_SCALE is 1.0
+    uint8_t numSamples;       // number of ETX samples taken, saturates at 0xff
+} neighborEtx_t;
+
 BEGIN_PACK
 typedef struct {
     uint8_t row;
@@ -57,6 +113,8 @@ END_PACK
 
 typedef struct {
     neighborRow_t neighbors[MAXNUMNEIGHBORS];
+    neighborEtx_t etx[MAXNUMNEIGHBORS];       // ETX estimator of each row, kept apart from the rows printed over serial
+    uint8_t rowIndex[NEIGHBORS_HASH_SIZE];    // neighbors row of each used address, by hash of its EUI-64
     dagrank_t myDAGrank;
     uint8_t debugRow;
 } neighbors_vars_t;
@@ -70,8 +128,6 @@ dagrank_t neighbors_getNeighborRank(uint8_t index);
 
 uint8_t neighbors_getNumNeighbors(void);
 
-uint16_t neighbors_getLinkMetric(uint8_t index);
-
 open_addr_t* neighbors_getKANeighbor(uint16_t kaPeriod);
 
 open_addr_t* neighbors_getJoinProxy(void);
@@ -82,8 +138,14 @@ int8_t neighbors_getRssi(uint8_t index);
 
 uint8_t neighbors_getNumTx(uint8_t index);
 
+uint16_t neighbors_getEtx(uint8_t index);
+
+uint8_t neighbors_getEtxConfidence(uint8_t index);
+
 uint8_t neighbors_getSequenceNumber(open_addr_t *address);
 
+uint8_t neighbors_getNeighborIndex(open_addr_t *address);
+
 // setters
 void neighbors_setNeighborRank(uint8_t index, dagrank_t rank);
 
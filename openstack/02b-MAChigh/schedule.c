@@ -22,6 +22,22 @@ void schedule_resetEntry(scheduleEntry_t *pScheduleEntry);
 
 void schedule_resetBackupEntry(backupEntry_t *pBackupEntry);
 
+slotframeEntry_t* schedule_getSlotframe(uint8_t frameHandle);
+
+bool schedule_findSlotOffset(slotframeEntry_t *slotframe, slotOffset_t slotOffset, uint8_t *position);
+
+void schedule_insertActiveSlot(slotframeEntry_t *slotframe, uint8_t position);
+
+void schedule_unlinkActiveSlot(slotframeEntry_t *slotframe, uint8_t position);
+
+void schedule_syncSlotframe(slotframeEntry_t *slotframe);
+
+void schedule_selectCurrentEntry(void);
+
+frameLength_t schedule_getSlotframeSlotsToNextActiveSlot(slotframeEntry_t *slotframe);
+
+slotOffset_t schedule_getAsnSlotOffset(asn_t *asn, frameLength_t frameLength);
+
 //=========================== public ==========================================
 
 //=== admin
@@ -42,10 +58,15 @@ void schedule_init(void) {
         for (i = 0; i < MAXBACKUPSLOTS; i++) {
             schedule_resetBackupEntry(&schedule_vars.scheduleBuf[running_slotOffset].backupEntries[i]);
         }
+        // all rows start in the free part of the slot index
+        schedule_vars.activeSlots[running_slotOffset] = running_slotOffset;
     }
     schedule_vars.backoffExponenton = MINBE - 1;
     schedule_vars.maxActiveSlots = MAXACTIVESLOTS;
 
+    // the first slotframe always exists, its handle and length are set later on
+    schedule_vars.numSlotframes = 1;
+
     if (idmanager_getIsDAGroot() == TRUE) {
         schedule_startDAGroot();
     }
@@ -61,7 +82,7 @@ void schedule_startDAGroot(void) {
 
     start_slotOffset = SCHEDULE_MINIMAL_6TISCH_SLOTOFFSET;
     // set frame length, handle and number (default 1 by now)
-    if (schedule_vars.frameLength == 0) {
+    if (schedule_vars.slotframes[0].frameLength == 0) {
         // slotframe length is not set, set it to default length
         schedule_setFrameLength(SLOTFRAME_LENGTH);
     } else {
@@ -144,7 +165,7 @@ bool debugPrint_backoff(void) {
 //=== from 6top (writing the schedule)
 
 /**
-\brief Set frame length.
+\brief Set frame length of the first slotframe.
 
 \param newFrameLength The new frame length.
 */
@@ -153,7 +174,9 @@ void schedule_setFrameLength(frameLength_t newFrameLength) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    schedule_vars.frameLength = newFrameLength;
+    schedule_vars.slotframes[0].frameLength = newFrameLength;
+    schedule_vars.slotframes[0].slotOffset = schedule_getAsnSlotOffset(&schedule_vars.currentAsn, newFrameLength);
+    schedule_syncSlotframe(&schedule_vars.slotframes[0]);
     if (newFrameLength <= MAXACTIVESLOTS) {
         schedule_vars.maxActiveSlots = newFrameLength;
     }
@@ -161,7 +184,7 @@ void schedule_setFrameLength(frameLength_t newFrameLength) {
 }
 
 /**
-\brief Set frame handle.
+\brief Set frame handle of the first slotframe.
 
 \param frameHandle The new frame handle.
 */
@@ -170,7 +193,7 @@ void schedule_setFrameHandle(uint8_t frameHandle) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    schedule_vars.frameHandle = frameHandle;
+    schedule_vars.slotframes[0].frameHandle = frameHandle;
 
     ENABLE_INTERRUPTS();
 }
@@ -190,6 +213,86 @@ void schedule_setFrameNumber(uint8_t frameNumber) {
     ENABLE_INTERRUPTS();
 }
 
+/**
+\brief Add a slotframe next to the first one.
+
+Its slots are aligned on the current ASN, i.e. its slotOffset 0 falls on the
+ASNs which are a multiple of frameLength.
+
+\param frameHandle The handle of the new slotframe.
+\param frameLength The length of the new slotframe, in slots.
+
+\returns E_SUCCESS if the slotframe was added, E_FAIL otherwise.
+*/
+owerror_t schedule_addSlotframe(uint8_t frameHandle, frameLength_t frameLength) {
+    slotframeEntry_t *slotframe;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    if (frameLength == 0 || schedule_getSlotframe(frameHandle) != NULL) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_INVALID_PARAM, (errorparameter_t) frameHandle,
+                  (errorparameter_t) frameLength);
+        return E_FAIL;
+    }
+
+    if (schedule_vars.numSlotframes == MAXSLOTFRAMES) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_OVERFLOWN, (errorparameter_t) 1, (errorparameter_t) 0);
+        return E_FAIL;
+    }
+
+    // the new slotframe has no active slot yet, they will go at the end of the slot index
+    slotframe = &schedule_vars.slotframes[schedule_vars.numSlotframes];
+    slotframe->frameHandle = frameHandle;
+    slotframe->frameLength = frameLength;
+    slotframe->slotOffset = schedule_getAsnSlotOffset(&schedule_vars.currentAsn, frameLength);
+    slotframe->firstActiveSlot = schedule_vars.numActiveSlots;
+    slotframe->numActiveSlots = 0;
+    slotframe->currentActiveSlot = 0;
+    schedule_vars.numSlotframes++;
+
+    ENABLE_INTERRUPTS();
+
+    return E_SUCCESS;
+}
+
+/**
+\brief Remove a slotframe added with schedule_addSlotframe().
+
+Its active slots must have been removed before.
+
+\param frameHandle The handle of the slotframe to remove.
+
+\returns E_SUCCESS if the slotframe was removed, E_FAIL otherwise.
+*/
+owerror_t schedule_removeSlotframe(uint8_t frameHandle) {
+    slotframeEntry_t *slotframe;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    slotframe = schedule_getSlotframe(frameHandle);
+    if (slotframe == NULL || slotframe == &schedule_vars.slotframes[0] || slotframe->numActiveSlots > 0) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_INVALID_PARAM, (errorparameter_t) frameHandle, (errorparameter_t) 0);
+        return E_FAIL;
+    }
+
+    // an empty slotframe does not own any position in the slot index
+    memmove(
+            slotframe,
+            slotframe + 1,
+            (&schedule_vars.slotframes[schedule_vars.numSlotframes] - (slotframe + 1)) * sizeof(slotframeEntry_t)
+    );
+    schedule_vars.numSlotframes--;
+
+    ENABLE_INTERRUPTS();
+
+    return E_SUCCESS;
+}
+
 /**
 \brief Get the information of a specific slot.
 
@@ -199,22 +302,18 @@ void schedule_setFrameNumber(uint8_t frameNumber) {
 void schedule_getSlotInfo(slotOffset_t slotOffset, slotinfo_element_t *info) {
 
     scheduleEntry_t *slotContainer;
-
-    // find an empty schedule entry container
-    slotContainer = &schedule_vars.scheduleBuf[0];
-    while (slotContainer <= &schedule_vars.scheduleBuf[schedule_vars.maxActiveSlots - 1]) {
-        //check that this entry for that neighbour and timeslot is not already scheduled.
-        if (slotContainer->slotOffset == slotOffset) {
-            //it exists so this is an update.
-            info->link_type = slotContainer->type;
-            info->shared = slotContainer->shared;
-            info->slotOffset = slotOffset;
-            info->channelOffset = slotContainer->channelOffset;
-            info->isAutoCell = slotContainer->isAutoCell;
-            memcpy(&(info->address), &(slotContainer->neighbor), sizeof(open_addr_t));
-            return; //as this is an update. No need to re-insert as it is in the same position on the list.
-        }
-        slotContainer++;
+    uint8_t position;
+
+    // look up the slot in the first slotframe
+    if (schedule_findSlotOffset(&schedule_vars.slotframes[0], slotOffset, &position)) {
+        slotContainer = &schedule_vars.scheduleBuf[schedule_vars.activeSlots[position]];
+        info->link_type = slotContainer->type;
+        info->shared = slotContainer->shared;
+        info->slotOffset = slotOffset;
+        info->channelOffset = slotContainer->channelOffset;
+        info->isAutoCell = slotContainer->isAutoCell;
+        memcpy(&(info->address), &(slotContainer->neighbor), sizeof(open_addr_t));
+        return;
     }
     // return cell type off
     info->link_type = CELLTYPE_OFF;
@@ -225,7 +324,7 @@ void schedule_getSlotInfo(slotOffset_t slotOffset, slotinfo_element_t *info) {
 }
 
 /**
-\brief Add a new active slot into the schedule.
+\brief Add a new active slot into the first slotframe.
 
 \param slotOffset       The slotoffset of the new slot
 \param type             The type of the cell
@@ -241,15 +340,46 @@ owerror_t schedule_addActiveSlot(
         bool isAutoCell,
         channelOffset_t channelOffset,
         open_addr_t *neighbor
+) {
+    return schedule_addActiveSlotToSlotframe(
+            schedule_vars.slotframes[0].frameHandle,
+            slotOffset,
+            type,
+            shared,
+            isAutoCell,
+            channelOffset,
+            neighbor
+    );
+}
+
+/**
+\brief Add a new active slot into a slotframe.
+
+\param frameHandle      The handle of the slotframe
+\param slotOffset       The slotoffset of the new slot
+\param type             The type of the cell
+\param shared           Whether this cell is shared (TRUE) or not (FALSE).
+\param channelOffset    The channelOffset of the new slot
+\param neighbor         The neighbor associated with this cell (all 0's if
+   none)
+*/
+owerror_t schedule_addActiveSlotToSlotframe(
+        uint8_t frameHandle,
+        slotOffset_t slotOffset,
+        cellType_t type,
+        bool shared,
+        bool isAutoCell,
+        channelOffset_t channelOffset,
+        open_addr_t *neighbor
 ) {
     uint8_t asn[5];
+    slotframeEntry_t *slotframe;
     scheduleEntry_t *slotContainer;
-    scheduleEntry_t *previousSlotWalker;
-    scheduleEntry_t *nextSlotWalker;
 
     backupEntry_t *backupEntry;
 
     uint8_t i;
+    uint8_t position;
     bool entry_found;
     bool inBackupEntries;
 
@@ -258,33 +388,41 @@ owerror_t schedule_addActiveSlot(
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
+    slotframe = schedule_getSlotframe(frameHandle);
+    if (slotframe == NULL) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_INVALID_PARAM, (errorparameter_t) frameHandle, (errorparameter_t) 1);
+        return E_FAIL;
+    }
+
     // find an empty schedule entry container
     entry_found = FALSE;
     inBackupEntries = FALSE;
-    slotContainer = &schedule_vars.scheduleBuf[0];
-    do {
-        if (slotContainer->type != CELLTYPE_OFF) {
-            if (slotContainer->slotOffset == slotOffset) {
-                // found one entry with same slotoffset in schedule, check if there is space in second entries
-
-                for (i = 0; i < MAXBACKUPSLOTS; i++) {
-                    if (slotContainer->backupEntries[i].type == CELLTYPE_OFF) {
-                        inBackupEntries = TRUE;
-                        backupEntry = &(slotContainer->backupEntries[i]);
-                        break;
-                    }
-                }
-                if (inBackupEntries) {
-                    entry_found = TRUE;
-                    break;
-                }
+    if (schedule_findSlotOffset(slotframe, slotOffset, &position)) {
+        // found one entry with same slotoffset in schedule, check if there is space in second entries
+        slotContainer = &schedule_vars.scheduleBuf[schedule_vars.activeSlots[position]];
+
+        for (i = 0; i < MAXBACKUPSLOTS; i++) {
+            if (slotContainer->backupEntries[i].type == CELLTYPE_OFF) {
+                inBackupEntries = TRUE;
+                backupEntry = &(slotContainer->backupEntries[i]);
+                break;
             }
-            slotContainer++;
-        } else {
-            entry_found = TRUE;
-            break;
         }
-    } while (slotContainer <= &schedule_vars.scheduleBuf[schedule_vars.maxActiveSlots - 1]);
+        if (inBackupEntries == FALSE) {
+            // slot is already in schedule, and its backup entries are full
+            ENABLE_INTERRUPTS();
+            LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_ADD_DUPLICATE_SLOT,
+                      (errorparameter_t) slotOffset,
+                      (errorparameter_t) 0);
+            return E_FAIL;
+        }
+        entry_found = TRUE;
+    } else if (schedule_vars.numActiveSlots < schedule_vars.maxActiveSlots) {
+        // the first free row of the slot index is the one released last
+        slotContainer = &schedule_vars.scheduleBuf[schedule_vars.activeSlots[schedule_vars.numActiveSlots]];
+        entry_found = TRUE;
+    }
 
     // abort it schedule overflow
     if (entry_found == FALSE) {
@@ -293,7 +431,7 @@ owerror_t schedule_addActiveSlot(
         return E_FAIL;
     }
 
-    // assign the next slot pointer if it's allocated in backup entries
+    // the slot is already in the slot index if it's allocated in backup entries
     if (inBackupEntries) {
 
         // the highest priority cell should be in schedule
@@ -330,7 +468,6 @@ owerror_t schedule_addActiveSlot(
             backupEntry->lastUsedAsn.byte4 = slotContainer->lastUsedAsn.byte4;
             backupEntry->lastUsedAsn.bytes0and1 = slotContainer->lastUsedAsn.bytes0and1;
             backupEntry->lastUsedAsn.bytes0and1 = slotContainer->lastUsedAsn.bytes0and1;
-            backupEntry->next = slotContainer->next;
 
             // add cell to schedule
             slotContainer->type = type;
@@ -358,9 +495,6 @@ owerror_t schedule_addActiveSlot(
             backupEntry->lastUsedAsn.bytes0and1 = 256 * asn[1] + asn[0];
             backupEntry->lastUsedAsn.bytes2and3 = 256 * asn[3] + asn[2];
             backupEntry->lastUsedAsn.byte4 = asn[4];
-
-            // use the same next point in schedule
-            backupEntry->next = slotContainer->next;
         }
         ENABLE_INTERRUPTS();
         return E_SUCCESS;
@@ -380,67 +514,15 @@ owerror_t schedule_addActiveSlot(
     slotContainer->lastUsedAsn.bytes2and3 = 256 * asn[3] + asn[2];
     slotContainer->lastUsedAsn.byte4 = asn[4];
 
-    // insert in circular list
-    if (schedule_vars.currentScheduleEntry == NULL) {
-        // this is the first active slot added
-
-        // the next slot of this slot is this slot
-        slotContainer->next = slotContainer;
-
-        // current slot points to this slot
-        schedule_vars.currentScheduleEntry = slotContainer;
-    } else {
-        // this is NOT the first active slot added
-
-        // find position in schedule
-        previousSlotWalker = schedule_vars.currentScheduleEntry;
-        while (1) {
-            nextSlotWalker = previousSlotWalker->next;
-            if (
-                    (
-                            (previousSlotWalker->slotOffset < slotContainer->slotOffset) &&
-                            (slotContainer->slotOffset < nextSlotWalker->slotOffset)
-                    )
-                    ||
-                    (
-                            (previousSlotWalker->slotOffset < slotContainer->slotOffset) &&
-                            (nextSlotWalker->slotOffset <= previousSlotWalker->slotOffset)
-                    )
-                    ||
-                    (
-                            (slotContainer->slotOffset < nextSlotWalker->slotOffset) &&
-                            (nextSlotWalker->slotOffset <= previousSlotWalker->slotOffset)
-                    )
-                    ) {
-                break;
-            }
-            if (previousSlotWalker->slotOffset == slotContainer->slotOffset) {
-                // slot is already in schedule
-                LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_ADD_DUPLICATE_SLOT,
-                          (errorparameter_t) slotContainer->slotOffset,
-                          (errorparameter_t) 0);
-                // reset the entry
-                slotContainer->slotOffset = 0;
-                slotContainer->type = CELLTYPE_OFF;
-                slotContainer->shared = FALSE;
-                slotContainer->channelOffset = 0;
-                memset(&slotContainer->neighbor, 0, sizeof(open_addr_t));
-                ENABLE_INTERRUPTS();
-                return E_FAIL;
-            }
-            previousSlotWalker = nextSlotWalker;
-        }
-        // insert between previousSlotWalker and nextSlotWalker
-        previousSlotWalker->next = slotContainer;
-        slotContainer->next = nextSlotWalker;
-    }
+    // insert in the slot index, at the position found above
+    schedule_insertActiveSlot(slotframe, position);
 
     ENABLE_INTERRUPTS();
     return E_SUCCESS;
 }
 
 /**
-\brief Remove an active slot from the schedule.
+\brief Remove an active slot from the first slotframe.
 
 \param slotOffset       The slotoffset of the slot to remove.
 \param type             The type of the slot to remove.
@@ -449,14 +531,41 @@ owerror_t schedule_addActiveSlot(
    none)
 */
 owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bool isShared, open_addr_t *neighbor) {
+    return schedule_removeActiveSlotFromSlotframe(
+            schedule_vars.slotframes[0].frameHandle,
+            slotOffset,
+            type,
+            isShared,
+            neighbor
+    );
+}
+
+/**
+\brief Remove an active slot from a slotframe.
+
+\param frameHandle      The handle of the slotframe.
+\param slotOffset       The slotoffset of the slot to remove.
+\param type             The type of the slot to remove.
+\param isShared         The slot is shared or not.
+\param neighbor         The neighbor associated with this cell (all 0's if
+   none)
+*/
+owerror_t schedule_removeActiveSlotFromSlotframe(
+        uint8_t frameHandle,
+        slotOffset_t slotOffset,
+        cellType_t type,
+        bool isShared,
+        open_addr_t *neighbor
+) {
     uint8_t i;
     bool entry_found;
     bool isbackupEntry;
     backupEntry_t *backupEntry;
     uint8_t candidate_index;
+    uint8_t position;
 
+    slotframeEntry_t *slotframe;
     scheduleEntry_t *slotContainer;
-    scheduleEntry_t *previousSlotWalker;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
@@ -464,31 +573,27 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
     // find the schedule entry
     entry_found = FALSE;
     isbackupEntry = FALSE;
-    slotContainer = &schedule_vars.scheduleBuf[0];
-    while (slotContainer <= &schedule_vars.scheduleBuf[schedule_vars.maxActiveSlots - 1]) {
-        if (slotContainer->slotOffset == slotOffset) {
-            if (packetfunctions_sameAddress(neighbor, &(slotContainer->neighbor))) {
-                entry_found = TRUE;
-                break;
-            } else {
-                for (i = 0; i < MAXBACKUPSLOTS; i++) {
-                    if (
-                            packetfunctions_sameAddress(neighbor, &(slotContainer->backupEntries[i].neighbor)) &&
-                            type == slotContainer->backupEntries[i].type &&
-                            isShared == slotContainer->backupEntries[i].shared
-                            ) {
-                        isbackupEntry = TRUE;
-                        backupEntry = &(slotContainer->backupEntries[i]);
-                        break;
-                    }
-                }
-                if (isbackupEntry) {
-                    entry_found = TRUE;
+    slotframe = schedule_getSlotframe(frameHandle);
+    if (slotframe != NULL && schedule_findSlotOffset(slotframe, slotOffset, &position)) {
+        slotContainer = &schedule_vars.scheduleBuf[schedule_vars.activeSlots[position]];
+        if (packetfunctions_sameAddress(neighbor, &(slotContainer->neighbor))) {
+            entry_found = TRUE;
+        } else {
+            for (i = 0; i < MAXBACKUPSLOTS; i++) {
+                if (
+                        packetfunctions_sameAddress(neighbor, &(slotContainer->backupEntries[i].neighbor)) &&
+                        type == slotContainer->backupEntries[i].type &&
+                        isShared == slotContainer->backupEntries[i].shared
+                        ) {
+                    isbackupEntry = TRUE;
+                    backupEntry = &(slotContainer->backupEntries[i]);
                     break;
                 }
             }
+            if (isbackupEntry) {
+                entry_found = TRUE;
+            }
         }
-        slotContainer++;
     }
 
     // abort it could not find
@@ -511,7 +616,6 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
         backupEntry->lastUsedAsn.bytes0and1 = 0;
         backupEntry->lastUsedAsn.bytes2and3 = 0;
         backupEntry->lastUsedAsn.byte4 = 0;
-        backupEntry->next = NULL;
 
         ENABLE_INTERRUPTS();
         return E_SUCCESS;
@@ -556,40 +660,8 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
         }
     }
 
-    // remove from linked list
-    if (slotContainer->next == slotContainer) {
-        // this is the last active slot, the next slot of this slot is NULL
-        slotContainer->next = NULL;
-
-        // current slot points to this slot
-        schedule_vars.currentScheduleEntry = NULL;
-    } else {
-        // this is NOT the last active slot, find the previous in the schedule
-        previousSlotWalker = schedule_vars.currentScheduleEntry;
-
-        while (1) {
-            if (previousSlotWalker->next == slotContainer) {
-                break;
-            }
-            previousSlotWalker = previousSlotWalker->next;
-        }
-
-        // remove this element from the linked list, i.e. have the previous slot "jump" to slotContainer's next
-        previousSlotWalker->next = slotContainer->next;
-
-        // update current slot if points to slot I just removed
-        if (schedule_vars.currentScheduleEntry == slotContainer) {
-            /**
-                attention: this should only happen at the end of slot. It's dangerous to remove current schedule entry
-                in the middle of the slot. The item access of currentScheduleEntry could be from unexpected entry.
-
-                In case the entry is removed at endSlot(), the currentScheduleEntry should be the previous entry. This
-                is because when the next active slot arrives, currentScheduleEntry will be assigned as
-                currentScheduleEntry->next
-            */
-            schedule_vars.currentScheduleEntry = previousSlotWalker;
-        }
-    }
+    // remove from the slot index
+    schedule_unlinkActiveSlot(slotframe, position);
 
     // reset removed schedule entry
     schedule_resetEntry(slotContainer);
@@ -600,47 +672,49 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
 }
 
 bool schedule_isSlotOffsetAvailable(uint16_t slotOffset) {
-
-    scheduleEntry_t *scheduleWalker;
+    uint8_t position;
+    bool returnVal;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    if (slotOffset >= schedule_vars.frameLength) {
+    if (slotOffset >= schedule_vars.slotframes[0].frameLength) {
         ENABLE_INTERRUPTS();
         return FALSE;
     }
 
-    scheduleWalker = schedule_vars.currentScheduleEntry;
-    do {
-        if (slotOffset == scheduleWalker->slotOffset) {
-            ENABLE_INTERRUPTS();
-            return FALSE;
-        }
-        scheduleWalker = scheduleWalker->next;
-    } while (scheduleWalker != schedule_vars.currentScheduleEntry);
+    returnVal = schedule_findSlotOffset(&schedule_vars.slotframes[0], slotOffset, &position) == FALSE;
 
     ENABLE_INTERRUPTS();
 
-    return TRUE;
+    return returnVal;
 }
 
 void schedule_removeAllNegotiatedCellsToNeighbor(uint8_t slotframeID, open_addr_t *neighbor) {
     uint8_t i;
+    slotframeEntry_t *slotframe;
+    scheduleEntry_t *scheduleEntry;
 
-    // remove all entries in schedule with previousHop address
-    for (i = 0; i < MAXACTIVESLOTS; i++) {
+    slotframe = schedule_getSlotframe(slotframeID);
+    if (slotframe == NULL) {
+        return;
+    }
+
+    // remove all entries in slotframe with previousHop address, from the last one as removing shifts the next ones
+    for (i = slotframe->numActiveSlots; i > 0; i--) {
+        scheduleEntry = &schedule_vars.scheduleBuf[schedule_vars.activeSlots[slotframe->firstActiveSlot + i - 1]];
         if (
-                packetfunctions_sameAddress(&(schedule_vars.scheduleBuf[i].neighbor), neighbor) &&
+                packetfunctions_sameAddress(&(scheduleEntry->neighbor), neighbor) &&
                 (
-                        schedule_vars.scheduleBuf[i].type == CELLTYPE_TX ||
-                        schedule_vars.scheduleBuf[i].type == CELLTYPE_RX
+                        scheduleEntry->type == CELLTYPE_TX ||
+                        scheduleEntry->type == CELLTYPE_RX
                 )
                 ) {
-            schedule_removeActiveSlot(
-                    schedule_vars.scheduleBuf[i].slotOffset,
-                    schedule_vars.scheduleBuf[i].type,
-                    schedule_vars.scheduleBuf[i].shared,
+            schedule_removeActiveSlotFromSlotframe(
+                    slotframeID,
+                    scheduleEntry->slotOffset,
+                    scheduleEntry->type,
+                    scheduleEntry->shared,
                     neighbor
             );
         }
@@ -898,48 +972,251 @@ bool schedule_getAutonomousTxRxCellAnycast(uint16_t *slotoffset) {
 
 //=== from IEEE802154E: reading the schedule and updating statistics
 
-void schedule_syncSlotOffset(slotOffset_t targetSlotOffset) {
+/**
+\brief Move the schedule to an ASN.
+
+Each slotframe moves to its slotOffset at that ASN. The current schedule
+entry becomes the active slot at that ASN, or the last one before it.
+*/
+void schedule_syncAsn(asn_t *asn) {
+    slotframeEntry_t *slotframe;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    while (schedule_vars.currentScheduleEntry->slotOffset != targetSlotOffset) {
-        schedule_advanceSlot();
+    memcpy(&schedule_vars.currentAsn, asn, sizeof(asn_t));
+    for (
+            slotframe = &schedule_vars.slotframes[0];
+            slotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            slotframe++
+            ) {
+        slotframe->slotOffset = schedule_getAsnSlotOffset(asn, slotframe->frameLength);
+        schedule_syncSlotframe(slotframe);
     }
+    schedule_selectCurrentEntry();
 
     ENABLE_INTERRUPTS();
 }
 
 /**
 \brief advance to next active slot
+
+The next active slot is the closest one over all slotframes. When several
+slotframes have an active slot there, the one with the lowest handle becomes
+the current schedule entry.
 */
 void schedule_advanceSlot(void) {
+    frameLength_t slotsToNextActiveSlot;
+    slotframeEntry_t *slotframe;
+    scheduleEntry_t *scheduleEntry;
+    uint8_t frameHandle;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    slotsToNextActiveSlot = schedule_getSlotsToNextActiveSlot();
+    if (slotsToNextActiveSlot == 0) {
+        // no active slot
+        ENABLE_INTERRUPTS();
+        return;
+    }
+
+    scheduleEntry = NULL;
+    frameHandle = 0;
+    for (
+            slotframe = &schedule_vars.slotframes[0];
+            slotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            slotframe++
+            ) {
+        if (slotframe->frameLength == 0) {
+            continue;
+        }
+        if (schedule_getSlotframeSlotsToNextActiveSlot(slotframe) == slotsToNextActiveSlot) {
+            // this slotframe has an active slot at the new ASN
+            slotframe->currentActiveSlot++;
+            if (slotframe->currentActiveSlot >= slotframe->numActiveSlots) {
+                slotframe->currentActiveSlot = 0;
+            }
+            if (scheduleEntry == NULL || slotframe->frameHandle < frameHandle) {
+                frameHandle = slotframe->frameHandle;
+                scheduleEntry = &schedule_vars.scheduleBuf[
+                        schedule_vars.activeSlots[slotframe->firstActiveSlot + slotframe->currentActiveSlot]];
+            }
+        }
+        slotframe->slotOffset = ((uint32_t) slotframe->slotOffset + slotsToNextActiveSlot) % slotframe->frameLength;
+    }
+    schedule_vars.currentScheduleEntry = scheduleEntry;
+
+    schedule_vars.currentAsn.bytes0and1 += slotsToNextActiveSlot;
+    if (schedule_vars.currentAsn.bytes0and1 < slotsToNextActiveSlot) {
+        schedule_vars.currentAsn.bytes2and3++;
+        if (schedule_vars.currentAsn.bytes2and3 == 0) {
+            schedule_vars.currentAsn.byte4++;
+        }
+    }
+
+    ENABLE_INTERRUPTS();
+}
+
+/**
+\brief Whether the slot at an ASN is the next active slot.
+
+The schedule only moves at active slots, by the slots to the next one. When a
+slot was aborted before advancing it, or a resynchronization skipped a slot,
+the schedule is out of step with the ASN: it first moves to the slot before
+that ASN. The next active slot is the closest one over all slotframes, however
+far it is in the first slotframe.
+
+\param[in] asn The ASN of the slot starting.
+
+\returns TRUE if schedule_advanceSlot() moves to that slot, FALSE otherwise.
+*/
+bool schedule_isNextActiveSlot(asn_t *asn) {
+    frameLength_t slotsToNextActiveSlot;
+    uint32_t slotsSinceCurrentAsn;
+    asn_t previousAsn;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    schedule_vars.currentScheduleEntry = schedule_vars.currentScheduleEntry->next;
+
+    slotsToNextActiveSlot = schedule_getSlotsToNextActiveSlot();
+    if (slotsToNextActiveSlot == 0) {
+        // no active slot
+        ENABLE_INTERRUPTS();
+        return FALSE;
+    }
+
+    slotsSinceCurrentAsn = (((uint32_t) asn->bytes2and3 << 16) + asn->bytes0and1) -
+                           (((uint32_t) schedule_vars.currentAsn.bytes2and3 << 16) +
+                            schedule_vars.currentAsn.bytes0and1);
+    if (slotsSinceCurrentAsn == 0 || slotsSinceCurrentAsn > slotsToNextActiveSlot) {
+        // out of step, move to the slot before this ASN
+        memcpy(&previousAsn, asn, sizeof(asn_t));
+        previousAsn.bytes0and1--;
+        if (previousAsn.bytes0and1 == 0xffff) {
+            previousAsn.bytes2and3--;
+            if (previousAsn.bytes2and3 == 0xffff) {
+                previousAsn.byte4--;
+            }
+        }
+        schedule_syncAsn(&previousAsn);
+        slotsToNextActiveSlot = schedule_getSlotsToNextActiveSlot();
+        slotsSinceCurrentAsn = 1;
+    }
 
     ENABLE_INTERRUPTS();
+
+    return slotsSinceCurrentAsn == slotsToNextActiveSlot;
 }
 
 /**
-\brief return slotOffset of next active slot
+\brief Get the number of slots from the current slot to the next active slot, over all slotframes.
+
+\returns The number of slots, 0 if there is no active slot.
 */
-slotOffset_t schedule_getNextActiveSlotOffset(void) {
-    slotOffset_t res;
+frameLength_t schedule_getSlotsToNextActiveSlot(void) {
+    slotframeEntry_t *slotframe;
+    frameLength_t slotsToNextActiveSlot;
+    frameLength_t returnVal;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    res = ((scheduleEntry_t *) (schedule_vars.currentScheduleEntry->next))->slotOffset;
+    returnVal = 0;
+    for (
+            slotframe = &schedule_vars.slotframes[0];
+            slotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            slotframe++
+            ) {
+        slotsToNextActiveSlot = schedule_getSlotframeSlotsToNextActiveSlot(slotframe);
+        if (slotsToNextActiveSlot > 0 && (returnVal == 0 || slotsToNextActiveSlot < returnVal)) {
+            returnVal = slotsToNextActiveSlot;
+        }
+    }
 
     ENABLE_INTERRUPTS();
 
-    return res;
+    return returnVal;
 }
 
 /**
-\brief Get the frame length.
+\brief Look ahead at the next active cell, to know whether we may transmit in it.
+
+The schedule is not advanced, the cell is the one schedule_advanceSlot() will
+select. A shared cell qualifies only when it is the minimal cell and its
+backoff lets us send in it.
+
+\param[out] neighbor The neighbor of that cell.
+\param[out] asn      The ASN of that cell.
+
+\returns TRUE if the next active cell is a TX cell we may send in, FALSE otherwise.
+*/
+bool schedule_getNextTxCell(open_addr_t *neighbor, asn_t *asn) {
+    frameLength_t slotsToNextActiveSlot;
+    slotframeEntry_t *slotframe;
+    scheduleEntry_t *scheduleEntry;
+    uint8_t frameHandle;
+    uint8_t position;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    slotsToNextActiveSlot = schedule_getSlotsToNextActiveSlot();
+    if (slotsToNextActiveSlot == 0) {
+        // no active slot
+        ENABLE_INTERRUPTS();
+        return FALSE;
+    }
+
+    scheduleEntry = NULL;
+    frameHandle = 0;
+    for (
+            slotframe = &schedule_vars.slotframes[0];
+            slotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            slotframe++
+            ) {
+        if (slotframe->frameLength == 0) {
+            continue;
+        }
+        if (
+                schedule_getSlotframeSlotsToNextActiveSlot(slotframe) == slotsToNextActiveSlot &&
+                (scheduleEntry == NULL || slotframe->frameHandle < frameHandle)
+                ) {
+            position = slotframe->currentActiveSlot + 1;
+            if (position >= slotframe->numActiveSlots) {
+                position = 0;
+            }
+            frameHandle = slotframe->frameHandle;
+            scheduleEntry = &schedule_vars.scheduleBuf[
+                    schedule_vars.activeSlots[slotframe->firstActiveSlot + position]];
+        }
+    }
+
+    if (
+            scheduleEntry == NULL ||
+            (scheduleEntry->type != CELLTYPE_TX && scheduleEntry->type != CELLTYPE_TXRX) ||
+            (scheduleEntry->shared && (scheduleEntry->neighbor.type != ADDR_ANYCAST || schedule_vars.backoff > 1))
+            ) {
+        ENABLE_INTERRUPTS();
+        return FALSE;
+    }
+
+    memcpy(neighbor, &scheduleEntry->neighbor, sizeof(open_addr_t));
+    memcpy(asn, &schedule_vars.currentAsn, sizeof(asn_t));
+    asn->bytes0and1 += slotsToNextActiveSlot;
+    if (asn->bytes0and1 < slotsToNextActiveSlot) {
+        asn->bytes2and3++;
+        if (asn->bytes2and3 == 0) {
+            asn->byte4++;
+        }
+    }
+
+    ENABLE_INTERRUPTS();
+    return TRUE;
+}
+
+/**
+\brief Get the frame length of the first slotframe.
 
 \returns The frame length.
 */
@@ -949,7 +1226,7 @@ frameLength_t schedule_getFrameLength(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.frameLength;
+    returnVal = schedule_vars.slotframes[0].frameLength;
 
     ENABLE_INTERRUPTS();
 
@@ -1201,6 +1478,8 @@ bool schedule_getOneCellAfterOffset(uint8_t metadata, uint8_t offset, open_addr_
     bool returnVal;
     scheduleEntry_t *scheduleWalker;
     cellType_t type;
+    slotframeEntry_t *slotframe;
+    uint8_t position;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
@@ -1216,16 +1495,18 @@ bool schedule_getOneCellAfterOffset(uint8_t metadata, uint8_t offset, open_addr_
     }
 
     returnVal = FALSE;
-    scheduleWalker = &schedule_vars.scheduleBuf[0]; // fisrt entry record slotoffset 0
-    do {
-        if (type == scheduleWalker->type && scheduleWalker->slotOffset >= offset) {
+    // the slot index is sorted, start from the first active slot at or after offset
+    slotframe = &schedule_vars.slotframes[0];
+    schedule_findSlotOffset(slotframe, offset, &position);
+    for (; position < slotframe->firstActiveSlot + slotframe->numActiveSlots; position++) {
+        scheduleWalker = &schedule_vars.scheduleBuf[schedule_vars.activeSlots[position]];
+        if (type == scheduleWalker->type) {
             *slotoffset = scheduleWalker->slotOffset;
             *channeloffset = scheduleWalker->channelOffset;
             returnVal = TRUE;
             break;
         }
-        scheduleWalker = scheduleWalker->next;
-    } while (scheduleWalker != &schedule_vars.scheduleBuf[0]);
+    }
 
     ENABLE_INTERRUPTS();
 
@@ -1254,7 +1535,6 @@ void schedule_resetEntry(scheduleEntry_t *e) {
     e->lastUsedAsn.bytes0and1 = 0;
     e->lastUsedAsn.bytes2and3 = 0;
     e->lastUsedAsn.byte4 = 0;
-    e->next = NULL;
 }
 
 void schedule_resetBackupEntry(backupEntry_t *e) {
@@ -1272,6 +1552,260 @@ void schedule_resetBackupEntry(backupEntry_t *e) {
     e->lastUsedAsn.bytes0and1 = 0;
     e->lastUsedAsn.bytes2and3 = 0;
     e->lastUsedAsn.byte4 = 0;
-    e->next = NULL;
+}
+
+/**
+\brief Get the slotframe with a given handle.
+
+\returns A pointer to the slotframe, NULL if there is none with that handle.
+
+\pre This function assumes interrupts are already disabled.
+*/
+slotframeEntry_t* schedule_getSlotframe(uint8_t frameHandle) {
+    uint8_t i;
+
+    for (i = 0; i < schedule_vars.numSlotframes; i++) {
+        if (schedule_vars.slotframes[i].frameHandle == frameHandle) {
+            return &schedule_vars.slotframes[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+\brief Look up a slotOffset in the slot index.
+
+Binary search over the positions of the slotframe in
+schedule_vars.activeSlots, which are kept sorted by slotOffset.
+
+\param slotframe  The slotframe to look in.
+\param slotOffset The slotOffset to look for.
+\param position   Set to the position of that slotOffset in the slot index
+   if found, otherwise to the position it would be inserted at.
+
+\returns TRUE if slotOffset is an active slot, FALSE otherwise.
+
+\pre This function assumes interrupts are already disabled.
+*/
+bool schedule_findSlotOffset(slotframeEntry_t *slotframe, slotOffset_t slotOffset, uint8_t *position) {
+    uint8_t low;
+    uint8_t high;
+    uint8_t middle;
+
+    low = slotframe->firstActiveSlot;
+    high = slotframe->firstActiveSlot + slotframe->numActiveSlots;
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (schedule_vars.scheduleBuf[schedule_vars.activeSlots[middle]].slotOffset < slotOffset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    *position = low;
+
+    return low < slotframe->firstActiveSlot + slotframe->numActiveSlots &&
+           schedule_vars.scheduleBuf[schedule_vars.activeSlots[low]].slotOffset == slotOffset;
+}
+
+/**
+\brief Insert the first free row of the slot index at a given position.
+
+The caller has filled that row of scheduleBuf; its slotOffset must sort at
+position in the slotframe.
+
+\pre This function assumes interrupts are already disabled.
+*/
+void schedule_insertActiveSlot(slotframeEntry_t *slotframe, uint8_t position) {
+    slotframeEntry_t *nextSlotframe;
+    uint8_t row;
+
+    row = schedule_vars.activeSlots[schedule_vars.numActiveSlots];
+    memmove(
+            &schedule_vars.activeSlots[position + 1],
+            &schedule_vars.activeSlots[position],
+            schedule_vars.numActiveSlots - position
+    );
+    schedule_vars.activeSlots[position] = row;
+    schedule_vars.numActiveSlots++;
+    slotframe->numActiveSlots++;
+
+    // the active slots of the next slotframes moved one position up
+    for (
+            nextSlotframe = slotframe + 1;
+            nextSlotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            nextSlotframe++
+            ) {
+        nextSlotframe->firstActiveSlot++;
+    }
+    schedule_syncSlotframe(slotframe);
+
+    if (schedule_vars.currentScheduleEntry == NULL) {
+        // this is the first active slot added, current slot points to this slot
+        schedule_vars.currentScheduleEntry = &schedule_vars.scheduleBuf[row];
+    }
+}
+
+/**
+\brief Move the slot at a given position to the free part of the slot index.
+
+The released row goes first in the free part, so it is the next one reused.
+
+\pre This function assumes interrupts are already disabled.
+*/
+void schedule_unlinkActiveSlot(slotframeEntry_t *slotframe, uint8_t position) {
+    slotframeEntry_t *nextSlotframe;
+    uint8_t row;
+
+    row = schedule_vars.activeSlots[position];
+    memmove(
+            &schedule_vars.activeSlots[position],
+            &schedule_vars.activeSlots[position + 1],
+            schedule_vars.numActiveSlots - position - 1
+    );
+    schedule_vars.numActiveSlots--;
+    schedule_vars.activeSlots[schedule_vars.numActiveSlots] = row;
+    slotframe->numActiveSlots--;
+
+    // the active slots of the next slotframes moved one position down
+    for (
+            nextSlotframe = slotframe + 1;
+            nextSlotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            nextSlotframe++
+            ) {
+        nextSlotframe->firstActiveSlot--;
+    }
+    schedule_syncSlotframe(slotframe);
+
+    if (schedule_vars.currentScheduleEntry == &schedule_vars.scheduleBuf[row]) {
+        /**
+            attention: this should only happen at the end of slot. It's dangerous to remove current schedule entry
+            in the middle of the slot. The item access of currentScheduleEntry could be from unexpected entry.
+
+            In case the entry is removed at endSlot(), the currentScheduleEntry falls back on the previous entry.
+        */
+        schedule_selectCurrentEntry();
+    }
+}
+
+/**
+\brief Point the slotframe at its last active slot at or before its slotOffset.
+
+Wraps around to its last active slot if there is none before slotOffset.
+
+\pre This function assumes interrupts are already disabled.
+*/
+void schedule_syncSlotframe(slotframeEntry_t *slotframe) {
+    uint8_t position;
+
+    if (slotframe->numActiveSlots == 0) {
+        slotframe->currentActiveSlot = 0;
+        return;
+    }
+
+    if (schedule_findSlotOffset(slotframe, slotframe->slotOffset, &position) == FALSE) {
+        // not an active slot, stop at the active slot before it so the next one follows slotOffset
+        if (position == slotframe->firstActiveSlot) {
+            position += slotframe->numActiveSlots;
+        }
+        position--;
+    }
+    slotframe->currentActiveSlot = position - slotframe->firstActiveSlot;
+}
+
+/**
+\brief Select the current schedule entry after the slotframes moved.
+
+This is the active slot at the current ASN of the slotframe with the lowest
+handle. Without active slot at the current ASN, this is the last active slot of
+the first slotframe which has one.
+
+\pre This function assumes interrupts are already disabled.
+*/
+void schedule_selectCurrentEntry(void) {
+    slotframeEntry_t *slotframe;
+    scheduleEntry_t *scheduleEntry;
+    bool isActiveSlot;
+    uint8_t frameHandle;
+
+    schedule_vars.currentScheduleEntry = NULL;
+    isActiveSlot = FALSE;
+    frameHandle = 0;
+    for (
+            slotframe = &schedule_vars.slotframes[0];
+            slotframe < &schedule_vars.slotframes[schedule_vars.numSlotframes];
+            slotframe++
+            ) {
+        if (slotframe->numActiveSlots == 0) {
+            continue;
+        }
+        scheduleEntry = &schedule_vars.scheduleBuf[
+                schedule_vars.activeSlots[slotframe->firstActiveSlot + slotframe->currentActiveSlot]];
+        if (scheduleEntry->slotOffset == slotframe->slotOffset) {
+            if (isActiveSlot == FALSE || slotframe->frameHandle < frameHandle) {
+                isActiveSlot = TRUE;
+                frameHandle = slotframe->frameHandle;
+                schedule_vars.currentScheduleEntry = scheduleEntry;
+            }
+        } else if (schedule_vars.currentScheduleEntry == NULL) {
+            schedule_vars.currentScheduleEntry = scheduleEntry;
+        }
+    }
+}
+
+/**
+\brief Get the number of slots from the current slot to the next active slot of a slotframe.
+
+This is a full frame when the slotframe has a single active slot, at the
+current slot.
+
+\returns The number of slots, 0 if the slotframe has no active slot.
+
+\pre This function assumes interrupts are already disabled.
+*/
+frameLength_t schedule_getSlotframeSlotsToNextActiveSlot(slotframeEntry_t *slotframe) {
+    uint8_t position;
+    uint32_t slotsToNextActiveSlot;
+
+    if (slotframe->numActiveSlots == 0 || slotframe->frameLength == 0) {
+        return 0;
+    }
+
+    position = slotframe->currentActiveSlot + 1;
+    if (position >= slotframe->numActiveSlots) {
+        position = 0;
+    }
+    slotsToNextActiveSlot = schedule_vars.scheduleBuf[
+            schedule_vars.activeSlots[slotframe->firstActiveSlot + position]].slotOffset;
+    slotsToNextActiveSlot = (slotsToNextActiveSlot + slotframe->frameLength - slotframe->slotOffset) %
+                            slotframe->frameLength;
+    if (slotsToNextActiveSlot == 0) {
+        slotsToNextActiveSlot = slotframe->frameLength;
+    }
+    return (frameLength_t) slotsToNextActiveSlot;
+}
+
+/**
+\brief Get the slotOffset of an ASN in a slotframe of a given length.
+
+\returns The slotOffset, 0 if the length is not known yet.
+*/
+slotOffset_t schedule_getAsnSlotOffset(asn_t *asn, frameLength_t frameLength) {
+    uint32_t slotOffset;
+
+    if (frameLength == 0) {
+        return 0;
+    }
+
+    slotOffset = asn->byte4;
+    slotOffset = slotOffset % frameLength;
+    slotOffset = slotOffset << 16;
+    slotOffset = slotOffset + asn->bytes2and3;
+    slotOffset = slotOffset % frameLength;
+    slotOffset = slotOffset << 16;
+    slotOffset = slotOffset + asn->bytes0and1;
+    slotOffset = slotOffset % frameLength;
+
+    return (slotOffset_t) slotOffset;
 }
 
@@ -60,12 +60,35 @@ in your schedule, so not to waste RAM.
 #define MAXACTIVESLOTS       SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS+NUMSLOTSOFF
 #endif
 
+#if MAXACTIVESLOTS > 0xff
+#error "MAXACTIVESLOTS does not fit the uint8_t slot index"
+#endif
+
+/**
+\brief Maximum number of concurrent slotframes.
+
+The first slotframe is the one advertised in EBs and the one 6top and the
+scheduling function manage, its handle and length are set through
+schedule_setFrameHandle() and schedule_setFrameLength(). Further slotframes,
+e.g. a short slotframe for negotiated data cells, are added with
+schedule_addSlotframe().
+
+When cells of several slotframes fall on the same ASN, the one in the
+slotframe with the lowest handle is used. The first slotframe must keep at
+least one active slot (the minimal cell), so the next active slot is always
+less than one of its frames away.
+*/
+#ifndef MAXSLOTFRAMES
+#define MAXSLOTFRAMES        3
+#endif
+
 /**
 \brief Maximum number of alternative slots (more than one cells with same slotOffset)
 
 
 Note that for each slot entry, it has a table of alternative slots. All
-those slots's next pointer is pointing to the same entries.
+those slots share the slotOffset, and the position in the slot index, of
+that entry.
 
 */
 #ifndef MAXBACKUPSLOTS
@@ -124,7 +147,6 @@ typedef struct {
     uint8_t numTx;
     uint8_t numTxACK;
     asn_t lastUsedAsn;
-    void *next;
 } backupEntry_t;
 
 typedef struct {
@@ -139,9 +161,17 @@ typedef struct {
     uint8_t numTxACK;
     asn_t lastUsedAsn;
     backupEntry_t backupEntries[MAXBACKUPSLOTS];
-    void *next;
 } scheduleEntry_t;
 
+typedef struct {
+    uint8_t frameHandle;
+    frameLength_t frameLength;
+    slotOffset_t slotOffset;        // slotOffset of the current slot of the schedule in this slotframe
+    uint8_t firstActiveSlot;        // position of the first active slot of this slotframe in the slot index
+    uint8_t numActiveSlots;
+    uint8_t currentActiveSlot;      // last active slot at or before slotOffset, relative to firstActiveSlot
+} slotframeEntry_t;
+
 BEGIN_PACK
 typedef struct {
     uint8_t row;
@@ -171,9 +201,12 @@ typedef struct {
 typedef struct {
     scheduleEntry_t scheduleBuf[MAXACTIVESLOTS];
     scheduleEntry_t *currentScheduleEntry;
-    frameLength_t frameLength;
+    uint8_t activeSlots[MAXACTIVESLOTS];    // scheduleBuf rows of the active slots of each slotframe sorted by slotOffset, then the free rows
+    uint8_t numActiveSlots;
+    slotframeEntry_t slotframes[MAXSLOTFRAMES]; // in the order of their active slots in activeSlots
+    uint8_t numSlotframes;
+    asn_t currentAsn;                       // ASN of the current slot of the schedule
     frameLength_t maxActiveSlots;
-    uint8_t frameHandle;
     uint8_t frameNumber;
     uint8_t backoffExponenton;
     uint8_t backoff;
@@ -198,6 +231,28 @@ void schedule_setFrameHandle(uint8_t frameHandle);
 
 void schedule_setFrameNumber(uint8_t frameNumber);
 
+owerror_t schedule_addSlotframe(uint8_t frameHandle, frameLength_t frameLength);
+
+owerror_t schedule_removeSlotframe(uint8_t frameHandle);
+
+owerror_t schedule_addActiveSlotToSlotframe(
+        uint8_t frameHandle,
+        slotOffset_t slotOffset,
+        cellType_t type,
+        bool shared,
+        bool isAutoCell,
+        uint8_t channelOffset,
+        open_addr_t *neighbor
+);
+
+owerror_t schedule_removeActiveSlotFromSlotframe(
+        uint8_t frameHandle,
+        slotOffset_t slotOffset,
+        cellType_t type,
+        bool isShared,
+        open_addr_t *neighbor
+);
+
 owerror_t schedule_addActiveSlot(
         slotOffset_t slotOffset,
         cellType_t type,
@@ -250,11 +305,15 @@ void schedule_hasNegotiatedTxCell(open_addr_t *address);
 bool schedule_hasNegotiatedTxCellToNonParent(open_addr_t *parentNeighbor, open_addr_t *nonParentNeighbor);
 
 // from IEEE802154E
-void schedule_syncSlotOffset(slotOffset_t targetSlotOffset);
+void schedule_syncAsn(asn_t *asn);
 
 void schedule_advanceSlot(void);
 
-slotOffset_t schedule_getNextActiveSlotOffset(void);
+bool schedule_isNextActiveSlot(asn_t *asn);
+
+frameLength_t schedule_getSlotsToNextActiveSlot(void);
+
+bool schedule_getNextTxCell(open_addr_t *neighbor, asn_t *asn);
 
 frameLength_t schedule_getFrameLength(void);
 
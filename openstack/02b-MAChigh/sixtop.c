@@ -22,6 +22,8 @@
 
 // in seconds: sixtop maintaince is called every 30 seconds
 #define MAINTENANCE_PERIOD        30
+// in miliseconds: how early the maintenance timer may fire to share a wakeup
+#define MAINTENANCE_SLACK         100
 /**
  Drop the 6P request if number of 6P response with RC RESET in queue is larger
     than MAX6PRESPONSE. Value 0 means that alway drop 6P response when the node
@@ -119,7 +121,7 @@ void sixtop_init(void) {
     sixtop_vars.kaPeriod = MAXKAPERIOD;
     sixtop_vars.six2six_state = SIX_STATE_IDLE;
 
-    sixtop_vars.ebSendingTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP);
+    sixtop_vars.ebSendingTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP, COMPONENT_SIXTOP);
     opentimers_scheduleIn(
             sixtop_vars.ebSendingTimerId,
             SLOTFRAME_LENGTH * SLOTDURATION,
@@ -128,7 +130,7 @@ void sixtop_init(void) {
             sixtop_sendingEb_timer_cb
     );
 
-    sixtop_vars.maintenanceTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP);
+    sixtop_vars.maintenanceTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP, COMPONENT_SIXTOP);
     opentimers_scheduleIn(
             sixtop_vars.maintenanceTimerId,
             sixtop_vars.periodMaintenance,
@@ -136,8 +138,9 @@ void sixtop_init(void) {
             TIMER_PERIODIC,
             sixtop_maintenance_timer_cb
     );
+    opentimers_setSlack(sixtop_vars.maintenanceTimerId, MAINTENANCE_SLACK, TIME_MS);
 
-    sixtop_vars.timeoutTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP);
+    sixtop_vars.timeoutTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP, COMPONENT_SIXTOP);
 }
 
 void  sixtop_setSFcallback(
@@ -306,8 +309,6 @@ owerror_t sixtop_request(
         return E_FAIL;
     }
     *((uint8_t * )(pkt->payload)) = code;
-    // record the code to determine the action after 6p senddone
-    pkt->l2_sixtop_command = code;
     len += 1;
 
     // append 6p version, T(type) and  R(reserved)
@@ -605,7 +606,7 @@ owerror_t sixtop_send_internal(
         return E_FAIL;
     }
     // change owner to IEEE802154E fetches it from queue
-    msg->owner = COMPONENT_SIXTOP_TO_IEEE802154E;
+    openqueue_macPutPacket(msg);
 
     if (
             packetfunctions_isBroadcastMulticast(&(msg->l2_nextORpreviousHop)) == FALSE &&
@@ -959,43 +960,43 @@ void sixtop_six2six_sendDone(OpenQueueEntry_t *msg, owerror_t error) {
         if (error == E_SUCCESS) {
             neighbors_updateSequenceNumber(&(msg->l2_nextORpreviousHop));
             // in case a response is sent out, check the return code
-            if (msg->l2_sixtop_returnCode == IANA_6TOP_RC_SUCCESS) {
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_ADD) {
+            if (msg->l2_sixtop->returnCode == IANA_6TOP_RC_SUCCESS) {
+                if (msg->l2_sixtop->command == IANA_6TOP_CMD_ADD) {
                     sixtop_addCells(
-                            msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_add,
+                            msg->l2_sixtop->frameID,
+                            msg->l2_sixtop->celllist_add,
                             &(msg->l2_nextORpreviousHop),
-                            msg->l2_sixtop_cellOptions
+                            msg->l2_sixtop->cellOptions
                     );
                 }
 
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_DELETE) {
+                if (msg->l2_sixtop->command == IANA_6TOP_CMD_DELETE) {
                     sixtop_removeCells(
-                            msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_delete,
+                            msg->l2_sixtop->frameID,
+                            msg->l2_sixtop->celllist_delete,
                             &(msg->l2_nextORpreviousHop),
-                            msg->l2_sixtop_cellOptions
+                            msg->l2_sixtop->cellOptions
                     );
                 }
 
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_RELOCATE) {
+                if (msg->l2_sixtop->command == IANA_6TOP_CMD_RELOCATE) {
                     sixtop_removeCells(
-                            msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_delete,
+                            msg->l2_sixtop->frameID,
+                            msg->l2_sixtop->celllist_delete,
                             &(msg->l2_nextORpreviousHop),
-                            msg->l2_sixtop_cellOptions
+                            msg->l2_sixtop->cellOptions
                     );
                     sixtop_addCells(
-                            msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_add,
+                            msg->l2_sixtop->frameID,
+                            msg->l2_sixtop->celllist_add,
                             &(msg->l2_nextORpreviousHop),
-                            msg->l2_sixtop_cellOptions
+                            msg->l2_sixtop->cellOptions
                     );
                 }
 
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_CLEAR) {
+                if (msg->l2_sixtop->command == IANA_6TOP_CMD_CLEAR) {
                     schedule_removeAllNegotiatedCellsToNeighbor(
-                            msg->l2_sixtop_frameID,
+                            msg->l2_sixtop->frameID,
                             &(msg->l2_nextORpreviousHop)
                     );
                     neighbors_resetSequenceNumber(&(msg->l2_nextORpreviousHop));
@@ -1008,8 +1009,8 @@ void sixtop_six2six_sendDone(OpenQueueEntry_t *msg, owerror_t error) {
             // doesn't receive the ACK of response packet from request side after maximum retries.
 
             // if the response is for CLEAR command, remove all the cells and reset seqnum regardless NO ack received.
-            if (msg->l2_sixtop_command == IANA_6TOP_CMD_CLEAR) {
-                schedule_removeAllNegotiatedCellsToNeighbor(msg->l2_sixtop_frameID, &(msg->l2_nextORpreviousHop));
+            if (msg->l2_sixtop->command == IANA_6TOP_CMD_CLEAR) {
+                schedule_removeAllNegotiatedCellsToNeighbor(msg->l2_sixtop->frameID, &(msg->l2_nextORpreviousHop));
                 neighbors_resetSequenceNumber(&(msg->l2_nextORpreviousHop));
             }
         }
@@ -1131,6 +1132,13 @@ void sixtop_six2six_notifyReceive(
         response_pkt->creator = COMPONENT_SIXTOP_RES;
         response_pkt->owner = COMPONENT_SIXTOP_RES;
 
+        // the cell lists of the response are kept until it is sent
+        if (openqueue_attachSixtopContext(response_pkt) == E_FAIL) {
+            LOG_ERROR(COMPONENT_SIXTOP_RES, ERR_NO_FREE_PACKET_BUFFER, (errorparameter_t) 1, (errorparameter_t) 0);
+            openqueue_freePacketBuffer(response_pkt);
+            return;
+        }
+
         memcpy(&(response_pkt->l2_nextORpreviousHop), &(pkt->l2_nextORpreviousHop), sizeof(open_addr_t));
 
         // the follow while loop only execute once
@@ -1282,31 +1290,31 @@ void sixtop_six2six_notifyReceive(
                 }
                 // retrieve cell list
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_add, 0, sizeof(response_pkt->l2_sixtop_celllist_add));
+                memset(response_pkt->l2_sixtop->celllist_add, 0, sizeof(response_pkt->l2_sixtop->celllist_add));
                 while (pktLen > 0) {
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset |=
+                    response_pkt->l2_sixtop->celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->l2_sixtop->celllist_add[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset |=
+                    response_pkt->l2_sixtop->celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->l2_sixtop->celllist_add[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                    response_pkt->l2_sixtop->celllist_add[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     i++;
                 }
-                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->l2_sixtop_celllist_add)) {
+                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->l2_sixtop->celllist_add)) {
                     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-                        if (response_pkt->l2_sixtop_celllist_add[i].isUsed) {
+                        if (response_pkt->l2_sixtop->celllist_add[i].isUsed) {
                             packetfunctions_reserveHeader(&response_pkt, 4);
                             response_pkt->payload[0] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0x00FF);
+                                    response_pkt->l2_sixtop->celllist_add[i].slotoffset & 0x00FF);
                             response_pkt->payload[1] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0xFF00) >> 8);
+                                    (response_pkt->l2_sixtop->celllist_add[i].slotoffset & 0xFF00) >> 8);
                             response_pkt->payload[2] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0x00FF);
+                                    response_pkt->l2_sixtop->celllist_add[i].channeloffset & 0x00FF);
                             response_pkt->payload[3] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0xFF00) >> 8);
+                                    (response_pkt->l2_sixtop->celllist_add[i].channeloffset & 0xFF00) >> 8);
                             response_pktLen += 4;
                         }
                     }
@@ -1318,15 +1326,15 @@ void sixtop_six2six_notifyReceive(
             // delete command
             if (code == IANA_6TOP_CMD_DELETE) {
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_delete, 0, sizeof(response_pkt->l2_sixtop_celllist_delete));
+                memset(response_pkt->l2_sixtop->celllist_delete, 0, sizeof(response_pkt->l2_sixtop->celllist_delete));
                 while (pktLen > 0) {
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset |=
+                    response_pkt->l2_sixtop->celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->l2_sixtop->celllist_delete[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset |=
+                    response_pkt->l2_sixtop->celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->l2_sixtop->celllist_delete[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].isUsed = TRUE;
+                    response_pkt->l2_sixtop->celllist_delete[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     i++;
@@ -1336,20 +1344,20 @@ void sixtop_six2six_notifyReceive(
                 } else {
                     cellOptions_transformed = cellOptions;
                 }
-                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->l2_sixtop_celllist_delete,
+                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->l2_sixtop->celllist_delete,
                                                         &(pkt->l2_nextORpreviousHop), cellOptions_transformed)) {
                     returnCode = IANA_6TOP_RC_SUCCESS;
                     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-                        if (response_pkt->l2_sixtop_celllist_delete[i].isUsed) {
+                        if (response_pkt->l2_sixtop->celllist_delete[i].isUsed) {
                             packetfunctions_reserveHeader(&response_pkt, 4);
                             response_pkt->payload[0] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset & 0x00FF);
+                                    response_pkt->l2_sixtop->celllist_delete[i].slotoffset & 0x00FF);
                             response_pkt->payload[1] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_delete[i].slotoffset & 0xFF00) >> 8);
+                                    (response_pkt->l2_sixtop->celllist_delete[i].slotoffset & 0xFF00) >> 8);
                             response_pkt->payload[2] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset & 0x00FF);
+                                    response_pkt->l2_sixtop->celllist_delete[i].channeloffset & 0x00FF);
                             response_pkt->payload[3] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_delete[i].channeloffset & 0xFF00) >> 8);
+                                    (response_pkt->l2_sixtop->celllist_delete[i].channeloffset & 0xFF00) >> 8);
                             response_pktLen += 4;
                         }
                     }
@@ -1363,16 +1371,16 @@ void sixtop_six2six_notifyReceive(
             if (code == IANA_6TOP_CMD_RELOCATE) {
                 // retrieve cell list to be relocated
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_delete, 0, sizeof(response_pkt->l2_sixtop_celllist_delete));
+                memset(response_pkt->l2_sixtop->celllist_delete, 0, sizeof(response_pkt->l2_sixtop->celllist_delete));
                 temp16 = numCells;
                 while (temp16 > 0) {
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset |=
+                    response_pkt->l2_sixtop->celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->l2_sixtop->celllist_delete[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset |=
+                    response_pkt->l2_sixtop->celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->l2_sixtop->celllist_delete[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].isUsed = TRUE;
+                    response_pkt->l2_sixtop->celllist_delete[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     temp16--;
@@ -1383,7 +1391,7 @@ void sixtop_six2six_notifyReceive(
                 } else {
                     cellOptions_transformed = cellOptions;
                 }
-                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->l2_sixtop_celllist_delete,
+                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->l2_sixtop->celllist_delete,
                                                         &(pkt->l2_nextORpreviousHop), cellOptions_transformed) ==
                     FALSE) {
                     returnCode = IANA_6TOP_RC_CELLLIST_ERR;
@@ -1391,31 +1399,31 @@ void sixtop_six2six_notifyReceive(
                 }
                 // retrieve cell list to be relocated
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_add, 0, sizeof(response_pkt->l2_sixtop_celllist_add));
+                memset(response_pkt->l2_sixtop->celllist_add, 0, sizeof(response_pkt->l2_sixtop->celllist_add));
                 while (pktLen > 0) {
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset |=
+                    response_pkt->l2_sixtop->celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->l2_sixtop->celllist_add[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset |=
+                    response_pkt->l2_sixtop->celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->l2_sixtop->celllist_add[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                    response_pkt->l2_sixtop->celllist_add[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     i++;
                 }
-                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->l2_sixtop_celllist_add)) {
+                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->l2_sixtop->celllist_add)) {
                     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-                        if (response_pkt->l2_sixtop_celllist_add[i].isUsed) {
+                        if (response_pkt->l2_sixtop->celllist_add[i].isUsed) {
                             packetfunctions_reserveHeader(&response_pkt, 4);
                             response_pkt->payload[0] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0x00FF);
+                                    response_pkt->l2_sixtop->celllist_add[i].slotoffset & 0x00FF);
                             response_pkt->payload[1] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0xFF00) >> 8);
+                                    (response_pkt->l2_sixtop->celllist_add[i].slotoffset & 0xFF00) >> 8);
                             response_pkt->payload[2] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0x00FF);
+                                    response_pkt->l2_sixtop->celllist_add[i].channeloffset & 0x00FF);
                             response_pkt->payload[3] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0xFF00) >> 8);
+                                    (response_pkt->l2_sixtop->celllist_add[i].channeloffset & 0xFF00) >> 8);
                             response_pktLen += 4;
                         }
                     }
@@ -1426,14 +1434,14 @@ void sixtop_six2six_notifyReceive(
         } while (0);
 
         // record code, returnCode, frameID and cellOptions. They will be used when 6p repsonse senddone
-        response_pkt->l2_sixtop_command = code;
-        response_pkt->l2_sixtop_returnCode = returnCode;
-        response_pkt->l2_sixtop_frameID = metadata;
+        response_pkt->l2_sixtop->command = code;
+        response_pkt->l2_sixtop->returnCode = returnCode;
+        response_pkt->l2_sixtop->frameID = metadata;
         // revert tx and rx link option bits
         if ((cellOptions & (CELLOPTIONS_TX | CELLOPTIONS_RX)) != (CELLOPTIONS_TX | CELLOPTIONS_RX)) {
-            response_pkt->l2_sixtop_cellOptions = cellOptions ^ (CELLOPTIONS_TX | CELLOPTIONS_RX);
+            response_pkt->l2_sixtop->cellOptions = cellOptions ^ (CELLOPTIONS_TX | CELLOPTIONS_RX);
         } else {
-            response_pkt->l2_sixtop_cellOptions = cellOptions;
+            response_pkt->l2_sixtop->cellOptions = cellOptions;
         }
 
         // append 6p Seqnum
@@ -1487,20 +1495,20 @@ void sixtop_six2six_notifyReceive(
             switch (sixtop_vars.six2six_state) {
                 case SIX_STATE_WAIT_ADDRESPONSE:
                     i = 0;
-                    memset(pkt->l2_sixtop_celllist_add, 0, sizeof(pkt->l2_sixtop_celllist_add));
+                    memset(celllist_list, 0, sizeof(celllist_list));
                     while (pktLen > 0) {
-                        pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                        pkt->l2_sixtop_celllist_add[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                        pkt->l2_sixtop_celllist_add[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                        celllist_list[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                        celllist_list[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
+                        celllist_list[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                        celllist_list[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
+                        celllist_list[i].isUsed = TRUE;
                         ptr += 4;
                         pktLen -= 4;
                         i++;
                     }
                     sixtop_addCells(
                             sixtop_vars.cb_sf_getMetadata(),     // frame id
-                            pkt->l2_sixtop_celllist_add,  // celllist to be added
+                            celllist_list,  // celllist to be added
                             &(pkt->l2_nextORpreviousHop), // neighbor that cells to be added to
                             sixtop_vars.cellOptions       // cell options
                     );
@@ -1513,21 +1521,21 @@ void sixtop_six2six_notifyReceive(
                     break;
                 case SIX_STATE_WAIT_DELETERESPONSE:
                     i = 0;
-                    memset(pkt->l2_sixtop_celllist_delete, 0, sizeof(pkt->l2_sixtop_celllist_delete));
+                    memset(celllist_list, 0, sizeof(celllist_list));
                     while (pktLen > 0) {
-                        pkt->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                        pkt->l2_sixtop_celllist_delete[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                        pkt->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                        pkt->l2_sixtop_celllist_delete[i].channeloffset |=
+                        celllist_list[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                        celllist_list[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
+                        celllist_list[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                        celllist_list[i].channeloffset |=
                                 (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                        pkt->l2_sixtop_celllist_delete[i].isUsed = TRUE;
+                        celllist_list[i].isUsed = TRUE;
                         ptr += 4;
                         pktLen -= 4;
                         i++;
                     }
                     sixtop_removeCells(
                             sixtop_vars.cb_sf_getMetadata(),
-                            pkt->l2_sixtop_celllist_delete,
+                            celllist_list,
                             &(pkt->l2_nextORpreviousHop),
                             sixtop_vars.cellOptions
                     );
@@ -1535,13 +1543,13 @@ void sixtop_six2six_notifyReceive(
                     break;
                 case SIX_STATE_WAIT_RELOCATERESPONSE:
                     i = 0;
-                    memset(pkt->l2_sixtop_celllist_add, 0, sizeof(pkt->l2_sixtop_celllist_add));
+                    memset(celllist_list, 0, sizeof(celllist_list));
                     while (pktLen > 0) {
-                        pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                        pkt->l2_sixtop_celllist_add[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                        pkt->l2_sixtop_celllist_add[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                        celllist_list[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                        celllist_list[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
+                        celllist_list[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                        celllist_list[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
+                        celllist_list[i].isUsed = TRUE;
                         ptr += 4;
                         pktLen -= 4;
                         i++;
@@ -1554,7 +1562,7 @@ void sixtop_six2six_notifyReceive(
                     );
                     sixtop_addCells(
                             sixtop_vars.cb_sf_getMetadata(),     // frame id
-                            pkt->l2_sixtop_celllist_add,  // celllist to be added
+                            celllist_list,  // celllist to be added
                             &(pkt->l2_nextORpreviousHop), // neighbor that cells to be added to
                             sixtop_vars.cellOptions       // cell options
                     );
@@ -118,7 +118,7 @@ owerror_t frag_fragment6LoPacket(OpenQueueEntry_t *msg) {
 
             lowpan_fragment->l3_isFragment = TRUE;
             lowpan_fragment->owner = COMPONENT_FRAG;
-            lowpan_fragment->creator = msg->creator;
+            openqueue_setCreator(lowpan_fragment, msg->creator);
 
             if (remaining_bytes > MAX_FRAGMENT_SIZE)
                 fragment_length = MAX_FRAGMENT_SIZE;
@@ -250,14 +250,16 @@ void frag_sendDone(OpenQueueEntry_t *msg, owerror_t sendError) {
                 }
             }
 
-            if (frags_queued == FALSE) {
+            if (frags_queued == FALSE && original_msg != NULL) {
                 iphc_sendDone(original_msg, sendError);
             }
 
         } else if (sendError == E_FAIL && upward_relay == FALSE) {
             // transmission failed, remove the other fragments that are not locked in for transmission
             cleanup_fragments(datagram_tag);
-            iphc_sendDone(original_msg, sendError);
+            if (original_msg != NULL) {
+                iphc_sendDone(original_msg, sendError);
+            }
         } else {
             openqueue_freePacketBuffer(msg);
         }
@@ -333,7 +335,7 @@ void frag_receive(OpenQueueEntry_t *msg) {
                 store_fragment(msg, size, tag, offset);
             } else {
                 // fast forwarding / source routing
-                msg->creator = COMPONENT_FRAG;
+                openqueue_setCreator(msg, COMPONENT_FRAG);
                 allocate_vrb(msg, size, tag);
                 iphc_receive(msg);
             }
@@ -368,7 +370,7 @@ void frag_receive(OpenQueueEntry_t *msg) {
             if (i < NUM_OF_VRBS) {
                 // we have found a corresponding VRB for this subsequent fragment, update the fragment's next hop
                 msg->l3_useSourceRouting = TRUE;
-                msg->creator = COMPONENT_FRAG;
+                openqueue_setCreator(msg, COMPONENT_FRAG);
 
                 memcpy(&msg->l2_nextORpreviousHop, &frag_vars.vrbs[i].nexthop, sizeof(open_addr_t));
 
@@ -416,8 +418,11 @@ void frag_receive(OpenQueueEntry_t *msg) {
 static void cleanup_fragments(uint16_t datagram_tag) {
     uint32_t i;
     for (i = 0; i < FRAGMENT_BUFFER_SIZE; i++) {
-        if (frag_vars.fragmentBuf[i].datagram_tag == datagram_tag)
+        if (frag_vars.fragmentBuf[i].datagram_tag == datagram_tag) {
             RESET_FRAG_BUFFER_ENTRY(i);
+            // a fragment locked in for transmission stays until it is sent, the original packet is given back now
+            frag_vars.fragmentBuf[i].pOriginalMsg = NULL;
+        }
     }
 }
 
@@ -456,7 +461,7 @@ static void store_fragment(OpenQueueEntry_t *msg, uint16_t size, uint16_t tag, u
             frag_vars.fragmentBuf[i].pOriginalMsg = NULL;
 
             if (!has_timer) {
-                frag_vars.fragmentBuf[i].reassembly_timer = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_FRAG);
+                frag_vars.fragmentBuf[i].reassembly_timer = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_FRAG, COMPONENT_FRAG);
 
                 // get a timer for the fragment reassembly and add it to the timer queue
                 if ((frag_vars.fragmentBuf[i].reassembly_timer == ERROR_NO_AVAILABLE_ENTRIES) ||
@@ -584,7 +589,7 @@ static owerror_t allocate_vrb(OpenQueueEntry_t *frag1, uint16_t size, uint16_t t
             frag_vars.vrbs[i].left = (size - MAX_FRAGMENT_SIZE);
             frag_vars.vrbs[i].frag1 = frag1;
 
-            frag_vars.vrbs[i].forward_timer = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_FRAG);
+            frag_vars.vrbs[i].forward_timer = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_FRAG, COMPONENT_FRAG);
 
             // get a timer for the fragment forwarding and add it to the timer queue
             if ((frag_vars.vrbs[i].forward_timer == ERROR_NO_AVAILABLE_ENTRIES) ||
@@ -622,7 +627,7 @@ static void fast_forward_frags(uint16_t tag, uint16_t size, uint8_t vrb_pos) {
             frag_vars.fragmentBuf[i].datagram_tag == tag &&
             frag_vars.fragmentBuf[i].datagram_offset != 0) {
 
-            frag_vars.fragmentBuf[i].pFragment->creator = COMPONENT_FRAG;
+            openqueue_setCreator(frag_vars.fragmentBuf[i].pFragment, COMPONENT_FRAG);
             frag_vars.fragmentBuf[i].pFragment->l3_useSourceRouting = TRUE;
 
             // provide the stored fragment with the right next hop address
@@ -31,7 +31,10 @@
 #define MAX_FRAGMENT_SIZE           80
 
 #define FRAGMENT_BUFFER_SIZE        (((IPV6_PACKET_SIZE / MAX_FRAGMENT_SIZE) + 1) * BIGQUEUELENGTH)
-#define NUM_OF_VRBS                 2
+#if OPENWSN_6LO_FRAGMENTATION_C == 0
+// NUM_OF_VRBS comes with the fragmentation options in config.h, frag_vars has no VRB without fragmentation
+#define NUM_OF_VRBS                 0
+#endif
 #define NUM_OF_CONCURRENT_TIMERS    (NUM_OF_VRBS + BIGQUEUELENGTH)
 
 #define FRAG1_HEADER_SIZE           4
@@ -10,6 +10,7 @@
 #include "neighbors.h"
 #include "openbridge.h"
 #include "icmpv6rpl.h"
+#include "routingtable.h"
 
 //=========================== variables =======================================
 
@@ -230,6 +231,11 @@ owerror_t iphc_sendFromForwarding(
 
 //send from bridge: 6LoWPAN header already added by OpenLBR, send as is
 owerror_t iphc_sendFromBridge(OpenQueueEntry_t *msg) {
+    ipv6_header_iht ipv6_outer_header;
+    ipv6_header_iht ipv6_inner_header;
+    uint8_t page_length;
+    uint8_t nextHop;
+
     msg->owner = COMPONENT_IPHC;
     // error checking
     if (idmanager_getIsDAGroot() == FALSE) {
@@ -237,6 +243,23 @@ owerror_t iphc_sendFromBridge(OpenQueueEntry_t *msg) {
         return E_FAIL;
     }
 
+    // in storing mode, the bridge has no source route: send down towards the destination along my routes
+    if (icmpv6rpl_isStoringMode()) {
+        memset(&ipv6_outer_header, 0, sizeof(ipv6_header_iht));
+        memset(&ipv6_inner_header, 0, sizeof(ipv6_header_iht));
+        if (
+                iphc_retrieveIPv6Header(msg, &ipv6_outer_header, &ipv6_inner_header, &page_length) == E_SUCCESS &&
+                ipv6_outer_header.routing_header[0] == NULL &&
+                routingtable_getNextHop(&(ipv6_inner_header.dest), &nextHop)
+                ) {
+            neighbors_getNeighborEui64(&(msg->l2_nextORpreviousHop), ADDR_64B, nextHop);
+            if (ipv6_outer_header.hopByhop_option != NULL) {
+                // the packet goes down
+                *(ipv6_outer_header.hopByhop_option) |= O_FLAG;
+            }
+        }
+    }
+
     // send directly to sixtop layer (6lowpan headers still attached)
     return sixtop_send(msg);
 }
@@ -278,7 +301,17 @@ void iphc_receive(OpenQueueEntry_t *msg) {
     }
 
     // if the address is broadcast address, the ipv6 header is the inner header
-    if (idmanager_getIsDAGroot() == FALSE || packetfunctions_isBroadcastMulticast(&(ipv6_inner_header.dest))) {
+    // in storing mode, the DAGroot handles the ICMPv6 messages sent to it: it installs the routes of the DAOs of its
+    // children itself, as the bridge cannot build source routes from them
+    if (
+            idmanager_getIsDAGroot() == FALSE ||
+            packetfunctions_isBroadcastMulticast(&(ipv6_inner_header.dest)) ||
+            (
+                    icmpv6rpl_isStoringMode() &&
+                    idmanager_isMyAddress(&(ipv6_inner_header.dest)) &&
+                    ipv6_inner_header.next_header == IANA_ICMPv6
+            )
+            ) {
         packetfunctions_tossHeader(&msg, page_length);
         if (ipv6_outer_header.next_header == IANA_IPv6HOPOPT && ipv6_outer_header.hopByhop_option != NULL) {
             // retrieve hop-by-hop header (includes RPL option)
@@ -8,6 +8,7 @@
 #include "neighbors.h"
 #include "icmpv6.h"
 #include "icmpv6rpl.h"
+#include "routingtable.h"
 #include "udp.h"
 #include "debugpins.h"
 #include "scheduler.h"
@@ -85,6 +86,7 @@ owerror_t forwarding_send(OpenQueueEntry_t *msg) {
     bool dac;
     uint8_t dam;
     uint8_t next_header;
+    uint8_t nextHop;
 
     // take ownership over the packet
     msg->owner = COMPONENT_FORWARDING;
@@ -136,11 +138,11 @@ owerror_t forwarding_send(OpenQueueEntry_t *msg) {
     // to be set to a value as the following function can decrement it.
     ipv6_inner_header.hop_limit = IPHC_DEFAULT_HOP_LIMIT;
 
-    // create the RPL hop-by-hop option
+    // create the RPL hop-by-hop option, going down if I have a route to the destination
 
     forwarding_createRplOption(
             &rpl_option,      // rpl_option to fill in
-            0x00              // flags
+            routingtable_getNextHop(&(msg->l3_destinationAdd), &nextHop) ? O_FLAG : 0x00 // flags
     );
 
 #if DEADLINE_OPTION
@@ -284,6 +286,8 @@ void forwarding_receive(
 ) {
     uint8_t flags;
     uint16_t senderRank;
+    uint8_t nextHop;
+    bool down;
 
     // take ownership
     msg->owner = COMPONENT_FORWARDING;
@@ -335,7 +339,7 @@ void forwarding_receive(
         // this packet is not for me: relay
 
         // change the creator of the packet
-        msg->creator = COMPONENT_FORWARDING;
+        openqueue_setCreator(msg, COMPONENT_FORWARDING);
 
 #if DEADLINE_OPTION
         if (deadline_option != NULL) {
@@ -350,9 +354,9 @@ void forwarding_receive(
        }
 #endif
 
-        if (openqueue_isHighPriorityEntryEnough() == FALSE) {
-            // after change the creator to COMPONENT_FORWARDING, there is no space for high priority packet,
-            // drop this message by free the buffer.
+        if (openqueue_isWithinQuota(msg) == FALSE) {
+            // after change the creator to COMPONENT_FORWARDING, the forwarded packets take entries reserved to other
+            // traffic classes, drop this message by free the buffer.
             LOG_WARNING(COMPONENT_FORWARDING, ERR_FORWARDING_PACKET_DROPPED, (errorparameter_t) 0,
                         (errorparameter_t) 0);
             openqueue_freePacketBuffer(msg);
@@ -362,13 +366,15 @@ void forwarding_receive(
         if (ipv6_outer_header->next_header != IANA_IPv6ROUTE) {
             flags = rpl_option->flags;
             senderRank = rpl_option->senderRank;
-            if ((flags & O_FLAG) != 0) {
+            down = routingtable_getNextHop(&(msg->l3_destinationAdd), &nextHop);
+            if ((flags & O_FLAG) != 0 && down == FALSE) {
                 // wrong direction
                 LOG_ERROR(COMPONENT_FORWARDING, ERR_WRONG_DIRECTION,
                           (errorparameter_t) flags,
                           (errorparameter_t) senderRank);
             }
-            if (senderRank < icmpv6rpl_getMyDAGrank()) {
+            // the sender outranks me if the packet was going down, I outrank it otherwise
+            if ((flags & O_FLAG) != 0 ? senderRank > icmpv6rpl_getMyDAGrank() : senderRank < icmpv6rpl_getMyDAGrank()) {
                 // loop detected
                 // set flag
                 rpl_option->flags |= R_FLAG;
@@ -377,6 +383,10 @@ void forwarding_receive(
                           (errorparameter_t) senderRank,
                           (errorparameter_t) icmpv6rpl_getMyDAGrank());
             }
+            if (down) {
+                // in storing mode, a packet to one of my descendants goes down without a source routing header
+                rpl_option->flags |= O_FLAG;
+            }
             forwarding_createRplOption(rpl_option, rpl_option->flags);
 
 #if DEADLINE_OPTION
@@ -424,6 +434,7 @@ void forwarding_receive(
 */
 void forwarding_getNextHop(open_addr_t *destination128b, open_addr_t *addressToWrite64b) {
     uint8_t i;
+    uint8_t nextHop;
 
     if (packetfunctions_isBroadcastMulticast(destination128b)) {
         // IP destination is broadcast, send to 0xffffffffffffffff
@@ -431,6 +442,9 @@ void forwarding_getNextHop(open_addr_t *destination128b, open_addr_t *addressToW
         for (i = 0; i < 8; i++) {
             addressToWrite64b->addr_64b[i] = 0xff;
         }
+    } else if (routingtable_getNextHop(destination128b, &nextHop)) {
+        // destination is one of my descendants, send down towards it
+        neighbors_getNeighborEui64(addressToWrite64b, ADDR_64B, nextHop);
     } else {
         // destination is remote, send to preferred parent
         icmpv6rpl_getPreferredParentEui64(addressToWrite64b);
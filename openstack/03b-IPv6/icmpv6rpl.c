@@ -13,11 +13,12 @@
 #include "IEEE802154_security.h"
 #include "schedule.h"
 #include "msf.h"
+#include "routingtable.h"
 
 //=========================== definition ======================================
 
-#define DIO_PORTION 2
 #define DAO_PORTION 4
+#define DAO_TIMER_PERIOD (SLOTFRAME_LENGTH * SLOTDURATION) // in miliseconds
 
 //=========================== variables =======================================
 
@@ -32,12 +33,46 @@ void icmpv6rpl_timer_DIO_task(void);
 
 void sendDIO(void);
 
+void icmpv6rpl_startTrickleDIO(void);
+
 // DAO-related
 void icmpv6rpl_timer_DAO_cb(opentimers_id_t id);
 
 void icmpv6rpl_timer_DAO_task(void);
 
-void sendDAO(void);
+bool icmpv6rpl_daoChanged(void);
+
+uint8_t icmpv6rpl_getDAOTargets(uint8_t *targets);
+
+owerror_t icmpv6rpl_writeDAOTarget(OpenQueueEntry_t **msg);
+
+void sendDAO(bool newPath);
+
+void icmpv6rpl_indicateRxDAOAck(OpenQueueEntry_t *msg);
+
+void icmpv6rpl_indicateRxDAO(OpenQueueEntry_t *msg);
+
+void icmpv6rpl_sendDAOAck(open_addr_t *destination, uint8_t DAOSequence);
+
+// parent selection
+void icmpv6rpl_selectParent(void);
+
+void icmpv6rpl_rankCandidateParent(uint8_t neighborIndex);
+
+// objective functions
+void icmpv6rpl_setObjectiveFunction(uint16_t OCP);
+
+uint16_t icmpv6rpl_of0_getRankIncrease(uint8_t neighborIndex);
+
+uint16_t icmpv6rpl_mrhof_getRankIncrease(uint8_t neighborIndex);
+
+/**
+\brief Objective functions this router can join a DODAG with.
+*/
+static const icmpv6rpl_of_t icmpv6rpl_objectiveFunctions[] = {
+        {OCP_OF0,   2 * MINHOPRANKINCREASE,        icmpv6rpl_of0_getRankIncrease},
+        {OCP_MRHOF, MRHOF_PARENT_SWITCH_THRESHOLD, icmpv6rpl_mrhof_getRankIncrease},
+};
 
 //=========================== public ==========================================
 
@@ -94,7 +129,7 @@ void icmpv6rpl_init(void) {
     memcpy(&icmpv6rpl_vars.dioDestination.addr_128b[0], all_routers_multicast, sizeof(all_routers_multicast));
 
     icmpv6rpl_vars.dioPeriod = DIO_PERIOD;
-    icmpv6rpl_vars.timerIdDIO = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_RPL);
+    icmpv6rpl_vars.timerIdDIO = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_RPL, COMPONENT_ICMPv6RPL);
 
     //initialize PIO -> move this to dagroot code
     icmpv6rpl_vars.pio.type = RPL_OPTION_PIO;
@@ -126,18 +161,15 @@ void icmpv6rpl_init(void) {
     icmpv6rpl_vars.conf.DIORedun = 0; // 0
     icmpv6rpl_vars.conf.maxRankIncrease = 2048; //  2048
     icmpv6rpl_vars.conf.minHopRankIncrease = 256; //256
-    icmpv6rpl_vars.conf.OCP = 0; // 0 OF0
+    icmpv6rpl_vars.conf.OCP = RPL_OCP; // until the DODAG's one is learnt from a DIO
+    icmpv6rpl_setObjectiveFunction(icmpv6rpl_vars.conf.OCP);
     icmpv6rpl_vars.conf.reserved = 0;
     icmpv6rpl_vars.conf.defLifetime = 0xff; //infinite - limit for DAO period  -> 0xff
     icmpv6rpl_vars.conf.lifetimeUnit = 0xffff; // 0xffff
 
-    opentimers_scheduleIn(
-            icmpv6rpl_vars.timerIdDIO,
-            SLOTFRAME_LENGTH * SLOTDURATION,
-            TIME_MS,
-            TIMER_PERIODIC,
-            icmpv6rpl_timer_DIO_cb
-    );
+    trickle_init(&icmpv6rpl_vars.trickleDIO, icmpv6rpl_vars.timerIdDIO, icmpv6rpl_timer_DIO_cb);
+    icmpv6rpl_startTrickleDIO();
+    opentimers_setSlack(icmpv6rpl_vars.timerIdDIO, RPL_TIMER_SLACK, TIME_MS);
 
     //=== DAO
 
@@ -175,14 +207,15 @@ void icmpv6rpl_init(void) {
     icmpv6rpl_vars.dao_target.prefixLength = 0;
 
     icmpv6rpl_vars.daoPeriod = DAO_PERIOD;
-    icmpv6rpl_vars.timerIdDAO = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_RPL);
+    icmpv6rpl_vars.timerIdDAO = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_RPL, COMPONENT_ICMPv6RPL);
     opentimers_scheduleIn(
             icmpv6rpl_vars.timerIdDAO,
-            SLOTFRAME_LENGTH * SLOTDURATION,
+            DAO_TIMER_PERIOD,
             TIME_MS,
             TIMER_PERIODIC,
             icmpv6rpl_timer_DAO_cb
     );
+    opentimers_setSlack(icmpv6rpl_vars.timerIdDAO, RPL_TIMER_SLACK, TIME_MS);
 }
 
 void icmpv6rpl_writeDODAGid(uint8_t *dodagid) {
@@ -229,8 +262,12 @@ void icmpv6rpl_sendDone(OpenQueueEntry_t *msg, owerror_t error) {
     // I'm not busy sending DIO/DAO anymore
     if (packetfunctions_isBroadcastMulticast(&(msg->l2_nextORpreviousHop))) {
         icmpv6rpl_vars.busySendingDIO = FALSE;
-    } else {
+    } else if (((ICMPv6_ht *) (msg->l4_payload))->code == IANA_ICMPv6_RPL_DAO) {
         icmpv6rpl_vars.busySendingDAO = FALSE;
+        if (error != E_SUCCESS) {
+            // my parent did not get the DAO, send it again
+            icmpv6rpl_vars.daoPending = TRUE;
+        }
     }
 
     // free packet
@@ -257,7 +294,8 @@ void icmpv6rpl_receive(OpenQueueEntry_t *msg) {
     // handle message
     switch (icmpv6code) {
         case IANA_ICMPv6_RPL_DIS:
-            icmpv6rpl_timer_DIO_task();
+            // a neighbor is asking for DIOs, advertise quickly again (rfc6550#section-8.3)
+            trickle_inconsistent(&icmpv6rpl_vars.trickleDIO);
             break;
         case IANA_ICMPv6_RPL_DIO:
             if (idmanager_getIsDAGroot() == TRUE) {
@@ -275,8 +313,16 @@ void icmpv6rpl_receive(OpenQueueEntry_t *msg) {
             break;
 
         case IANA_ICMPv6_RPL_DAO:
-            // this should never happen
-            LOG_ERROR(COMPONENT_ICMPv6RPL, ERR_UNEXPECTED_DAO, (errorparameter_t) 0, (errorparameter_t) 0);
+            if (icmpv6rpl_isStoringMode()) {
+                // a child advertises its sub-DODAG
+                icmpv6rpl_indicateRxDAO(msg);
+            } else {
+                // this should never happen, DAOs travel to the DAGroot in non-storing mode
+                LOG_ERROR(COMPONENT_ICMPv6RPL, ERR_UNEXPECTED_DAO, (errorparameter_t) 0, (errorparameter_t) 0);
+            }
+            break;
+        case IANA_ICMPv6_RPL_DAO_ACK:
+            icmpv6rpl_indicateRxDAOAck(msg);
             break;
         default:
             // this should never happen
@@ -351,150 +397,52 @@ dagrank_t icmpv6rpl_getMyDAGrank(void) {
 }
 
 /**
-\brief Routing algorithm
+\brief Routing algorithm, re-ranking every neighbor as a candidate parent.
+
+To be called on topology events. When a single neighbor's link metric or rank
+changed, icmpv6rpl_indicateNeighborUpdate() re-ranks that neighbor only.
 */
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void) {
     uint8_t i;
-    uint16_t previousDAGrank;
-    uint16_t prevRankIncrease;
-    uint8_t prevParentIndex;
-    bool prevHadParent;
-    bool foundBetterParent;
-    // temporaries
-    uint16_t rankIncrease;
-    dagrank_t neighborRank;
-    uint32_t tentativeDAGrank;
-
-    open_addr_t newParent;
 
-    // if I'm a DAGroot, my DAGrank is always MINHOPRANKINCREASE
-    if ((idmanager_getIsDAGroot()) == TRUE) {
-        // the dagrank is not set through setting command, set
-        // test for change so as not to report unchanged value when root rank to MINHOPRANKINCREASE here
-        if (icmpv6rpl_vars.myDAGrank != MINHOPRANKINCREASE) {
-            icmpv6rpl_vars.myDAGrank = MINHOPRANKINCREASE;
-            return;
-        }
-    }
-    // prep for loop, remember state before neighbor table scanning
-    prevParentIndex = icmpv6rpl_vars.ParentIndex;
-    prevHadParent = icmpv6rpl_vars.haveParent;
-    prevRankIncrease = icmpv6rpl_vars.rankIncrease;
-    // update my rank to current parent first
-    if (icmpv6rpl_vars.haveParent == TRUE) {
-        if (neighbors_getNeighborNoResource(icmpv6rpl_vars.ParentIndex) == TRUE) {
-            icmpv6rpl_vars.myDAGrank = 65535;
-        } else {
-            if (neighbors_reachedMinimalTransmission(icmpv6rpl_vars.ParentIndex) == FALSE) {
-                // I havn't enough transmission to my parent, don't update.
-                return;
-            }
-            rankIncrease = neighbors_getLinkMetric(icmpv6rpl_vars.ParentIndex);
-            neighborRank = neighbors_getNeighborRank(icmpv6rpl_vars.ParentIndex);
-            tentativeDAGrank = (uint32_t) neighborRank + rankIncrease;
-            if (tentativeDAGrank > 65535) {
-                icmpv6rpl_vars.myDAGrank = 65535;
-            } else {
-                icmpv6rpl_vars.myDAGrank = (uint16_t) tentativeDAGrank;
-            }
-        }
-    }
-    previousDAGrank = icmpv6rpl_vars.myDAGrank;
-    foundBetterParent = FALSE;
-    icmpv6rpl_vars.haveParent = FALSE;
+    icmpv6rpl_vars.numFullParentSelections++;
 
-    // loop through neighbor table, update myDAGrank
+    icmpv6rpl_vars.numCandidateParents = 0;
     for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (neighbors_isStableNeighborByIndex(i)) { // in use and link is stable
-            // neighbor marked as NORES can't be parent
-            if (
-                    neighbors_getNeighborNoResource(i) == TRUE
-                    ) {
-                continue;
-            }
-            // get link cost to this neighbor
-            rankIncrease = neighbors_getLinkMetric(i);
-            // get this neighbor's advertized rank
-            neighborRank = neighbors_getNeighborRank(i);
-            // if this neighbor has unknown/infinite rank, pass on it
-            if (neighborRank == DEFAULTDAGRANK) continue;
-            // compute tentative cost of full path to root through this neighbor
-            tentativeDAGrank = (uint32_t) neighborRank + rankIncrease;
-            if (tentativeDAGrank > 65535) {
-                tentativeDAGrank = 65535;
-            }
-            // if larger than lowestRank+maxRankIncrease, pass (per rfc6550#section-8.2.2.4)
-            if (
-                    icmpv6rpl_vars.lowestRankInHistory<(MAXDAGRANK - DAGMAXRANKINCREASE) &&
-                                                       tentativeDAGrank>(
-                            icmpv6rpl_vars.lowestRankInHistory + DAGMAXRANKINCREASE)
-                    ) {
-                continue;
-            }
-            // if not low enough to justify switch, pass (i.e. hysterisis)
-            if (
-                    (previousDAGrank < tentativeDAGrank) ||
-                    (previousDAGrank - tentativeDAGrank < 2 * MINHOPRANKINCREASE)
-                    ) {
-                continue;
-            }
-            // remember that we have at least one valid candidate parent
-            foundBetterParent = TRUE;
-            // select best candidate so far
-            if (icmpv6rpl_vars.myDAGrank > tentativeDAGrank) {
-                if (tentativeDAGrank < icmpv6rpl_vars.lowestRankInHistory) {
-                    icmpv6rpl_vars.lowestRankInHistory = (uint16_t) tentativeDAGrank;
-                }
-                icmpv6rpl_vars.myDAGrank = (uint16_t) tentativeDAGrank;
-                icmpv6rpl_vars.ParentIndex = i;
-                icmpv6rpl_vars.rankIncrease = rankIncrease;
-            }
-        }
+        icmpv6rpl_rankCandidateParent(i);
     }
+    icmpv6rpl_vars.candidateParentsValid = TRUE;
 
-    if (foundBetterParent) {
-        icmpv6rpl_vars.haveParent = TRUE;
-        if (!prevHadParent) {
-            // in case preParent is killed before calling this function, clear the preferredParent flag
-            neighbors_setPreferredParent(prevParentIndex, FALSE);
-            // set neighbors as preferred parent
-            neighbors_setPreferredParent(icmpv6rpl_vars.ParentIndex, TRUE);
+    icmpv6rpl_selectParent();
+}
 
-            // update the upstream traffic nexthop address to new parent
-            neighbors_getNeighborEui64(&newParent, ADDR_64B, icmpv6rpl_vars.ParentIndex);
-            icmpv6rpl_updateNexthopAddress(&newParent);
+/**
+\brief Routing algorithm, after the link metric or the rank of a neighbor changed.
 
+\param[in] neighborIndex The index of that neighbor in the neighbor table.
+*/
+void icmpv6rpl_indicateNeighborUpdate(uint8_t neighborIndex) {
+    if (icmpv6rpl_vars.candidateParentsValid == FALSE) {
+        icmpv6rpl_updateMyDAGrankAndParentSelection();
+        return;
+    }
 
-        } else {
-            if (icmpv6rpl_vars.ParentIndex == prevParentIndex) {
-                // report on the rank change if any, not on the deletion/creation of parent
-                if (icmpv6rpl_vars.myDAGrank != previousDAGrank) {
-                } else {
-                    // same parent, same rank, nothing to report about
-                }
-            } else {
-                // clear neighbors preferredParent flag
-                neighbors_setPreferredParent(prevParentIndex, FALSE);
-                // set neighbors as preferred parent
-                neighbors_setPreferredParent(icmpv6rpl_vars.ParentIndex, TRUE);
+    icmpv6rpl_vars.numIncrementalParentSelections++;
 
-                // update the upstream traffic nexthop address to new parent
-                neighbors_getNeighborEui64(&newParent, ADDR_64B, icmpv6rpl_vars.ParentIndex);
-                icmpv6rpl_updateNexthopAddress(&newParent);
-            }
-        }
-    } else {
-        // restore routing table as we found it on entry
-        icmpv6rpl_vars.myDAGrank = previousDAGrank;
-        icmpv6rpl_vars.ParentIndex = prevParentIndex;
-        icmpv6rpl_vars.haveParent = prevHadParent;
-        icmpv6rpl_vars.rankIncrease = prevRankIncrease;
-        // no change to report on
-    }
+    icmpv6rpl_rankCandidateParent(neighborIndex);
+    icmpv6rpl_selectParent();
+}
 
-    // if my rank is reached to MAXDAGRANK
-    if (icmpv6rpl_vars.myDAGrank == MAXDAGRANK) {
-        icmpv6rpl_vars.lowestRankInHistory = MAXDAGRANK;
+/**
+\brief Re-rank a neighbor as a candidate parent, without selecting a parent.
+
+To be called when a neighbor is removed or its link stability changes.
+
+\param[in] neighborIndex The index of that neighbor in the neighbor table.
+*/
+void icmpv6rpl_updateCandidateParent(uint8_t neighborIndex) {
+    if (icmpv6rpl_vars.candidateParentsValid == TRUE) {
+        icmpv6rpl_rankCandidateParent(neighborIndex);
     }
 }
 
@@ -528,9 +476,18 @@ void icmpv6rpl_indicateRxDIO(OpenQueueEntry_t *msg) {
     open_addr_t myPrefix;
     uint8_t *current;
     uint8_t optionsLen;
+    bool consistent;
+    bool prevHadParent;
+    uint8_t prevParentIndex;
+    icmpv6rpl_config_ht prevConf;
     // take ownership over the packet
     msg->owner = COMPONENT_ICMPv6RPL;
 
+    // a DIO is consistent if it advertises the same DODAG version and does not make me change parent
+    consistent = (((icmpv6rpl_dio_ht *) (msg->payload))->verNumb == icmpv6rpl_vars.dio.verNumb);
+    prevHadParent = icmpv6rpl_vars.haveParent;
+    prevParentIndex = icmpv6rpl_vars.ParentIndex;
+
     // update some fields of our DIO
     memcpy(
             &(icmpv6rpl_vars.dio),
@@ -563,8 +520,21 @@ void icmpv6rpl_indicateRxDIO(OpenQueueEntry_t *msg) {
                 icmpv6rpl_vars.incomingConf->lifetimeUnit = (icmpv6rpl_vars.incomingConf->lifetimeUnit << 8) |
                                                             (icmpv6rpl_vars.incomingConf->lifetimeUnit >> 8); // 0xffff
 
+                memcpy(&prevConf, &icmpv6rpl_vars.conf, sizeof(icmpv6rpl_config_ht));
                 memcpy(&icmpv6rpl_vars.conf, icmpv6rpl_vars.incomingConf, sizeof(icmpv6rpl_config_ht));
 
+                // rank the neighbors with the objective function of the DODAG
+                icmpv6rpl_setObjectiveFunction(icmpv6rpl_vars.conf.OCP);
+
+                // pace my DIOs with the Trickle parameters of the DODAG
+                if (
+                        icmpv6rpl_vars.conf.DIOIntMin != prevConf.DIOIntMin ||
+                        icmpv6rpl_vars.conf.DIOIntDoubl != prevConf.DIOIntDoubl ||
+                        icmpv6rpl_vars.conf.DIORedun != prevConf.DIORedun
+                        ) {
+                    icmpv6rpl_startTrickleDIO();
+                }
+
                 // do whatever needs to be done with the configuration option of RPL
                 optionsLen = optionsLen - current[1] - 2;
                 current = current + current[1] + 2;
@@ -620,11 +590,23 @@ void icmpv6rpl_indicateRxDIO(OpenQueueEntry_t *msg) {
                     neighbors_setNeighborRank(i, icmpv6rpl_vars.incomingDio->rank);
                 }
                 // since changes were made to neighbors DAG rank, run the routing algorithm again
-                icmpv6rpl_updateMyDAGrankAndParentSelection();
+                icmpv6rpl_indicateNeighborUpdate(i);
                 break; // there should be only one matching entry, no need to loop further
             }
         }
     }
+
+    if (
+            prevHadParent != icmpv6rpl_vars.haveParent ||
+            (prevHadParent && prevParentIndex != icmpv6rpl_vars.ParentIndex)
+            ) {
+        consistent = FALSE;
+    }
+    if (consistent) {
+        trickle_consistent(&icmpv6rpl_vars.trickleDIO);
+    } else {
+        trickle_inconsistent(&icmpv6rpl_vars.trickleDIO);
+    }
 }
 
 void icmpv6rpl_killPreferredParent(void) {
@@ -634,10 +616,275 @@ void icmpv6rpl_killPreferredParent(void) {
     } else {
         icmpv6rpl_vars.myDAGrank = DEFAULTDAGRANK;
     }
+    // losing my parent is an inconsistency (rfc6550#section-8.3)
+    trickle_inconsistent(&icmpv6rpl_vars.trickleDIO);
 }
 
 //=========================== private =========================================
 
+//===== parent selection
+
+/**
+\brief Select my parent and compute my rank from the candidate parents.
+*/
+void icmpv6rpl_selectParent(void) {
+    uint8_t i;
+    uint16_t previousDAGrank;
+    uint16_t prevRankIncrease;
+    uint8_t prevParentIndex;
+    bool prevHadParent;
+    bool foundBetterParent;
+    // temporaries
+    uint16_t rankIncrease;
+    dagrank_t neighborRank;
+    uint32_t tentativeDAGrank;
+
+    open_addr_t newParent;
+
+    // if I'm a DAGroot, my DAGrank is always MINHOPRANKINCREASE
+    if ((idmanager_getIsDAGroot()) == TRUE) {
+        // the dagrank is not set through setting command, set
+        // test for change so as not to report unchanged value when root rank to MINHOPRANKINCREASE here
+        if (icmpv6rpl_vars.myDAGrank != MINHOPRANKINCREASE) {
+            icmpv6rpl_vars.myDAGrank = MINHOPRANKINCREASE;
+            return;
+        }
+    }
+    // prep for loop, remember state before neighbor table scanning
+    prevParentIndex = icmpv6rpl_vars.ParentIndex;
+    prevHadParent = icmpv6rpl_vars.haveParent;
+    prevRankIncrease = icmpv6rpl_vars.rankIncrease;
+    // update my rank to current parent first
+    if (icmpv6rpl_vars.haveParent == TRUE) {
+        if (neighbors_getNeighborNoResource(icmpv6rpl_vars.ParentIndex) == TRUE) {
+            icmpv6rpl_vars.myDAGrank = 65535;
+        } else {
+            if (neighbors_reachedMinimalTransmission(icmpv6rpl_vars.ParentIndex) == FALSE) {
+                // I havn't enough transmission to my parent, don't update.
+                return;
+            }
+            rankIncrease = icmpv6rpl_vars.of->getRankIncrease(icmpv6rpl_vars.ParentIndex);
+            neighborRank = neighbors_getNeighborRank(icmpv6rpl_vars.ParentIndex);
+            tentativeDAGrank = (uint32_t) neighborRank + rankIncrease;
+            if (tentativeDAGrank > 65535) {
+                icmpv6rpl_vars.myDAGrank = 65535;
+            } else {
+                icmpv6rpl_vars.myDAGrank = (uint16_t) tentativeDAGrank;
+            }
+        }
+    }
+    previousDAGrank = icmpv6rpl_vars.myDAGrank;
+    foundBetterParent = FALSE;
+    icmpv6rpl_vars.haveParent = FALSE;
+
+    // the best candidate parent is the only one which can pass the checks below
+    if (icmpv6rpl_vars.numCandidateParents > 0) {
+        i = icmpv6rpl_vars.candidateParents[0];
+        tentativeDAGrank = icmpv6rpl_vars.candidateDAGrank[i];
+        if (
+                // if larger than lowestRank+maxRankIncrease, pass (per rfc6550#section-8.2.2.4)
+                (
+                        icmpv6rpl_vars.lowestRankInHistory >= (MAXDAGRANK - DAGMAXRANKINCREASE) ||
+                        tentativeDAGrank <= (icmpv6rpl_vars.lowestRankInHistory + DAGMAXRANKINCREASE)
+                ) &&
+                // if not low enough to justify switch, pass (i.e. hysterisis)
+                (
+                        (previousDAGrank >= tentativeDAGrank) &&
+                        (previousDAGrank - tentativeDAGrank >= icmpv6rpl_vars.of->parentSwitchThreshold)
+                )
+                ) {
+            // remember that we have at least one valid candidate parent
+            foundBetterParent = TRUE;
+            // select best candidate
+            if (tentativeDAGrank < icmpv6rpl_vars.lowestRankInHistory) {
+                icmpv6rpl_vars.lowestRankInHistory = (uint16_t) tentativeDAGrank;
+            }
+            icmpv6rpl_vars.myDAGrank = (uint16_t) tentativeDAGrank;
+            icmpv6rpl_vars.ParentIndex = i;
+            icmpv6rpl_vars.rankIncrease = icmpv6rpl_vars.candidateRankIncrease[i];
+        }
+    }
+
+    if (foundBetterParent) {
+        icmpv6rpl_vars.haveParent = TRUE;
+        if (!prevHadParent) {
+            // in case preParent is killed before calling this function, clear the preferredParent flag
+            neighbors_setPreferredParent(prevParentIndex, FALSE);
+            // set neighbors as preferred parent
+            neighbors_setPreferredParent(icmpv6rpl_vars.ParentIndex, TRUE);
+
+            // update the upstream traffic nexthop address to new parent
+            neighbors_getNeighborEui64(&newParent, ADDR_64B, icmpv6rpl_vars.ParentIndex);
+            icmpv6rpl_updateNexthopAddress(&newParent);
+
+            // advertise my new rank quickly
+            trickle_inconsistent(&icmpv6rpl_vars.trickleDIO);
+        } else {
+            if (icmpv6rpl_vars.ParentIndex == prevParentIndex) {
+                // report on the rank change if any, not on the deletion/creation of parent
+                if (icmpv6rpl_vars.myDAGrank != previousDAGrank) {
+                } else {
+                    // same parent, same rank, nothing to report about
+                }
+            } else {
+                // clear neighbors preferredParent flag
+                neighbors_setPreferredParent(prevParentIndex, FALSE);
+                // set neighbors as preferred parent
+                neighbors_setPreferredParent(icmpv6rpl_vars.ParentIndex, TRUE);
+
+                // update the upstream traffic nexthop address to new parent
+                neighbors_getNeighborEui64(&newParent, ADDR_64B, icmpv6rpl_vars.ParentIndex);
+                icmpv6rpl_updateNexthopAddress(&newParent);
+
+                // a parent change is an inconsistency (rfc6550#section-8.3)
+                trickle_inconsistent(&icmpv6rpl_vars.trickleDIO);
+            }
+        }
+    } else {
+        // restore routing table as we found it on entry
+        icmpv6rpl_vars.myDAGrank = previousDAGrank;
+        icmpv6rpl_vars.ParentIndex = prevParentIndex;
+        icmpv6rpl_vars.haveParent = prevHadParent;
+        icmpv6rpl_vars.rankIncrease = prevRankIncrease;
+        // no change to report on
+    }
+
+    // if my rank is reached to MAXDAGRANK
+    if (icmpv6rpl_vars.myDAGrank == MAXDAGRANK) {
+        icmpv6rpl_vars.lowestRankInHistory = MAXDAGRANK;
+    }
+}
+
+/**
+\brief Re-rank a neighbor in the candidate parents, best first.
+
+A candidate parent is a stable neighbor, not marked as 6P NORES and with a known
+rank. Candidates are ordered by the rank I would have through them, then by
+index, the order in which a scan of the neighbor table would prefer them.
+*/
+void icmpv6rpl_rankCandidateParent(uint8_t neighborIndex) {
+    uint8_t i;
+    uint8_t candidateIndex;
+    uint16_t rankIncrease;
+    dagrank_t neighborRank;
+    uint32_t tentativeDAGrank;
+
+    // remove this neighbor from the candidates
+    for (i = 0; i < icmpv6rpl_vars.numCandidateParents; i++) {
+        if (icmpv6rpl_vars.candidateParents[i] == neighborIndex) {
+            icmpv6rpl_vars.numCandidateParents--;
+            memmove(
+                    &icmpv6rpl_vars.candidateParents[i],
+                    &icmpv6rpl_vars.candidateParents[i + 1],
+                    icmpv6rpl_vars.numCandidateParents - i
+            );
+            break;
+        }
+    }
+
+    // in use and link is stable, neighbor marked as NORES can't be parent
+    if (
+            neighbors_isStableNeighborByIndex(neighborIndex) == FALSE ||
+            neighbors_getNeighborNoResource(neighborIndex) == TRUE
+            ) {
+        return;
+    }
+    // if this neighbor has unknown/infinite rank, pass on it
+    neighborRank = neighbors_getNeighborRank(neighborIndex);
+    if (neighborRank == DEFAULTDAGRANK) {
+        return;
+    }
+
+    // compute tentative cost of full path to root through this neighbor
+    rankIncrease = icmpv6rpl_vars.of->getRankIncrease(neighborIndex);
+    tentativeDAGrank = (uint32_t) neighborRank + rankIncrease;
+    if (tentativeDAGrank > 65535) {
+        tentativeDAGrank = 65535;
+    }
+    icmpv6rpl_vars.candidateDAGrank[neighborIndex] = (dagrank_t) tentativeDAGrank;
+    icmpv6rpl_vars.candidateRankIncrease[neighborIndex] = rankIncrease;
+
+    // insert it in order
+    for (i = 0; i < icmpv6rpl_vars.numCandidateParents; i++) {
+        candidateIndex = icmpv6rpl_vars.candidateParents[i];
+        if (
+                icmpv6rpl_vars.candidateDAGrank[candidateIndex] > tentativeDAGrank ||
+                (
+                        icmpv6rpl_vars.candidateDAGrank[candidateIndex] == tentativeDAGrank &&
+                        candidateIndex > neighborIndex
+                )
+                ) {
+            break;
+        }
+    }
+    memmove(
+            &icmpv6rpl_vars.candidateParents[i + 1],
+            &icmpv6rpl_vars.candidateParents[i],
+            icmpv6rpl_vars.numCandidateParents - i
+    );
+    icmpv6rpl_vars.candidateParents[i] = neighborIndex;
+    icmpv6rpl_vars.numCandidateParents++;
+}
+
+//===== objective functions
+
+/**
+\brief Select the objective function identified by some OCP.
+
+An OCP this router does not support leaves the objective function in use
+unchanged.
+*/
+void icmpv6rpl_setObjectiveFunction(uint16_t OCP) {
+    uint8_t i;
+
+    for (i = 0; i < sizeof(icmpv6rpl_objectiveFunctions) / sizeof(icmpv6rpl_of_t); i++) {
+        if (icmpv6rpl_objectiveFunctions[i].OCP == OCP) {
+            if (icmpv6rpl_vars.of != &icmpv6rpl_objectiveFunctions[i]) {
+                icmpv6rpl_vars.of = &icmpv6rpl_objectiveFunctions[i];
+                // the candidate parents are to be ranked again
+                icmpv6rpl_vars.candidateParentsValid = FALSE;
+                // ranks computed by another objective function can't be compared with
+                if (idmanager_getIsDAGroot() == FALSE) {
+                    icmpv6rpl_vars.lowestRankInHistory = MAXDAGRANK;
+                }
+            }
+            return;
+        }
+    }
+
+    if (icmpv6rpl_vars.of == NULL) {
+        icmpv6rpl_vars.of = &icmpv6rpl_objectiveFunctions[0];
+    }
+}
+
+/**
+\brief OF0 (RFC6552) rank increase, as profiled by 6TiSCH minimal: ((3*ETX)-2)*minHopRankIncrease
+*/
+uint16_t icmpv6rpl_of0_getRankIncrease(uint8_t neighborIndex) {
+    uint32_t rankIncrease;
+
+    rankIncrease = 3 * (uint32_t) neighbors_getEtx(neighborIndex) - 2 * NEIGHBORS_ETX_SCALE;
+    rankIncrease = (rankIncrease * MINHOPRANKINCREASE) / NEIGHBORS_ETX_SCALE;
+    if (rankIncrease > 65535) {
+        rankIncrease = 65535;
+    }
+    return (uint16_t) rankIncrease;
+}
+
+/**
+\brief MRHOF (RFC6719) rank increase: the ETX of the link, a link worse than
+   MRHOF_MAX_LINK_METRIC is not eligible.
+*/
+uint16_t icmpv6rpl_mrhof_getRankIncrease(uint8_t neighborIndex) {
+    uint32_t linkMetric;
+
+    linkMetric = ((uint32_t) neighbors_getEtx(neighborIndex) * MINHOPRANKINCREASE) / NEIGHBORS_ETX_SCALE;
+    if (linkMetric > MRHOF_MAX_LINK_METRIC) {
+        return 65535;
+    }
+    return (uint16_t) linkMetric;
+}
+
 //===== DIO-related
 
 /**
@@ -657,11 +904,32 @@ void icmpv6rpl_timer_DIO_cb(opentimers_id_t id) {
 */
 void icmpv6rpl_timer_DIO_task(void) {
 
-    if (openrandom_get16b() < (0xffff / DIO_PORTION)) {
+    if (trickle_timerFired(&icmpv6rpl_vars.trickleDIO)) {
         sendDIO();
     }
 }
 
+/**
+\brief (Re)start the Trickle timer of the DIOs with the DODAG configuration.
+
+Imin is 2^DIOIntMin ms, doubled at most DIOIntDoubl times, and DIORedun is the
+redundancy constant (0 never suppresses a DIO).
+*/
+void icmpv6rpl_startTrickleDIO(void) {
+    uint8_t intervalMin;
+
+    intervalMin = icmpv6rpl_vars.conf.DIOIntMin;
+    if (intervalMin > 31) {
+        intervalMin = 31;
+    }
+    trickle_start(
+            &icmpv6rpl_vars.trickleDIO,
+            (uint32_t) 1 << intervalMin,
+            icmpv6rpl_vars.conf.DIOIntDoubl,
+            icmpv6rpl_vars.conf.DIORedun
+    );
+}
+
 /**
 \brief Prepare and a send a RPL DIO.
 */
@@ -820,23 +1088,150 @@ void icmpv6rpl_timer_DAO_cb(opentimers_id_t id) {
 /**
 \brief Handler for DAO timer event.
 
+A DAO is only sent when my parent or my children changed, when the last one was
+lost, or when it is time to refresh it. If a DAO-ACK is requested, the last DAO
+is retransmitted with an exponential backoff until it is acknowledged.
+
 \note This function is executed in task context, called by the scheduler.
 */
 void icmpv6rpl_timer_DAO_task(void) {
 
-    if (openrandom_get16b() < (0xffff / DAO_PORTION)) {
-        sendDAO();
+    if (icmpv6rpl_vars.daoTimerCounter < 0xffff) {
+        icmpv6rpl_vars.daoTimerCounter++;
     }
+
+    // expire the routes my descendants did not refresh
+    routingtable_age(DAO_TIMER_PERIOD);
+
+    if (
+            icmpv6rpl_vars.daoPending ||
+            icmpv6rpl_daoChanged() ||
+            icmpv6rpl_vars.daoTimerCounter >= icmpv6rpl_vars.daoPeriod / DAO_TIMER_PERIOD
+            ) {
+        // new routing information, or refresh
+        if (openrandom_get16b() < (0xffff / DAO_PORTION)) {
+            sendDAO(TRUE);
+        }
+    } else if (
+            icmpv6rpl_vars.daoAckPending &&
+            icmpv6rpl_vars.daoTimerCounter >= (DAO_ACK_TIMEOUT / DAO_TIMER_PERIOD) << icmpv6rpl_vars.daoRetries
+            ) {
+        if (icmpv6rpl_vars.daoRetries < DAO_MAX_RETRIES) {
+            icmpv6rpl_vars.daoRetries++;
+            sendDAO(FALSE);
+        } else {
+            // give up until the next refresh
+            icmpv6rpl_vars.daoAckPending = FALSE;
+        }
+    }
+}
+
+/**
+\brief Whether my parent or my children differ from the ones in the last DAO.
+*/
+bool icmpv6rpl_daoChanged(void) {
+    uint8_t i;
+    uint8_t numTargets;
+    uint8_t targets[MAX_TARGET_PARENTS];
+    open_addr_t address;
+
+    if (icmpv6rpl_getPreferredParentEui64(&address) == FALSE) {
+        // nothing to advertise
+        return FALSE;
+    }
+    if (packetfunctions_sameAddress(&address, &icmpv6rpl_vars.daoParent) == FALSE) {
+        return TRUE;
+    }
+
+    numTargets = icmpv6rpl_getDAOTargets(targets);
+    if (numTargets != icmpv6rpl_vars.numDaoTargets) {
+        return TRUE;
+    }
+    for (i = 0; i < numTargets; i++) {
+        neighbors_getNeighborEui64(&address, ADDR_64B, targets[i]);
+        if (packetfunctions_sameAddress(&address, &icmpv6rpl_vars.daoTargets[i]) == FALSE) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+\brief Retrieve the children to advertise as targets in my DAO.
+
+In storing mode, my children are advertised from the routes their own DAOs
+installed, not from the neighbor table.
+
+\param[out] targets Neighbor indices of the children, MAX_TARGET_PARENTS at most.
+
+\returns The number of children written.
+*/
+uint8_t icmpv6rpl_getDAOTargets(uint8_t *targets) {
+    uint8_t nbrIdx;
+    uint8_t numTargets;
+
+    numTargets = 0;
+    if (icmpv6rpl_isStoringMode()) {
+        return numTargets;
+    }
+    for (nbrIdx = 0; nbrIdx < MAXNUMNEIGHBORS; nbrIdx++) {
+        if ((neighbors_isNeighborWithHigherDAGrank(nbrIdx)) == TRUE) {
+            // this neighbor is of higher DAGrank as I am. so it is my child
+            targets[numTargets++] = nbrIdx;
+        }
+        //limit to MAX_TARGET_PARENTS the number of DAO target addresses to send
+        //section 8.2.1 pag 67 RFC6550 -- using a subset
+        // poipoi TODO base selection on ETX rather than first X.
+        if (numTargets >= MAX_TARGET_PARENTS) break;
+    }
+    return numTargets;
+}
+
+/**
+\brief Write the header of a DAO "Target" option in front of its 128-bit address.
+*/
+owerror_t icmpv6rpl_writeDAOTarget(OpenQueueEntry_t **msg) {
+
+    // update target info fields
+    // from rfc6550 p.55 -- Variable, length of the option in octets excluding the Type and Length fields.
+    // poipoi xv: assuming that type and length fields refer to the 2 first bytes of the header
+    icmpv6rpl_vars.dao_target.optionLength =
+            LENGTH_ADDR128b + sizeof(icmpv6rpl_dao_target_ht) - 2; //no header type and length
+    icmpv6rpl_vars.dao_target.type = OPTION_TARGET_INFORMATION_TYPE;
+    icmpv6rpl_vars.dao_target.flags = 0;       //must be 0
+    icmpv6rpl_vars.dao_target.prefixLength = 128; //128 leading bits  -- full address.
+
+    // write target info in packet
+    if (packetfunctions_reserveHeader(msg, sizeof(icmpv6rpl_dao_target_ht)) == E_FAIL) {
+        return E_FAIL;
+    }
+    memcpy(
+            ((icmpv6rpl_dao_target_ht *) ((*msg)->payload)),
+            &(icmpv6rpl_vars.dao_target),
+            sizeof(icmpv6rpl_dao_target_ht)
+    );
+    return E_SUCCESS;
 }
 
 /**
 \brief Prepare and a send a RPL DAO.
+
+In storing mode, the DAO goes to my parent and advertises my own address and
+the targets of my routes, MAX_DAO_TARGETS at a time: the next ones go in the
+following DAOs.
+
+\param[in] newPath TRUE to advertise new routing information with new sequence
+    numbers, FALSE to retransmit the last DAO.
 */
-void sendDAO(void) {
+void sendDAO(bool newPath) {
     OpenQueueEntry_t *msg;                // pointer to DAO messages
-    uint8_t nbrIdx;             // running neighbor index
+    uint8_t i;
     uint8_t numTransitParents, numTargetParents;  // the number of parents indicated in transit option
+    uint8_t targets[MAX_TARGET_PARENTS];
+    uint8_t routeStart, route, numRoutes;
+    bool storing;
     open_addr_t address;
+    open_addr_t parent;
     open_addr_t *prefix;
 
     memset(&address, 0, sizeof(open_addr_t));
@@ -906,9 +1301,18 @@ void sendDAO(void) {
     msg->l4_protocol = IANA_ICMPv6;
     msg->l4_sourcePortORicmpv6Type = IANA_ICMPv6_RPL;
 
-    // set DAO destination
+    icmpv6rpl_getPreferredParentEui64(&parent);
+    prefix = idmanager_getMyID(ADDR_PREFIX);
+    storing = icmpv6rpl_isStoringMode();
+
+    // set DAO destination, my parent in storing mode (rfc6550#section-9.2), the DAGroot otherwise
     msg->l3_destinationAdd.type = ADDR_128B;
-    memcpy(msg->l3_destinationAdd.addr_128b, icmpv6rpl_vars.dio.DODAGID, sizeof(icmpv6rpl_vars.dio.DODAGID));
+    if (storing) {
+        memcpy(&msg->l3_destinationAdd.addr_128b[0], prefix->prefix, LENGTH_ADDR64b);
+        memcpy(&msg->l3_destinationAdd.addr_128b[8], parent.addr_64b, LENGTH_ADDR64b);
+    } else {
+        memcpy(msg->l3_destinationAdd.addr_128b, icmpv6rpl_vars.dio.DODAGID, sizeof(icmpv6rpl_vars.dio.DODAGID));
+    }
 
     //===== fill in packet
 
@@ -917,23 +1321,29 @@ void sendDAO(void) {
     //=== transit option -- from RFC 6550, page 55 - 1 transit information header per parent is required.
     //getting only preferred parent as transit
     numTransitParents = 0;
-    icmpv6rpl_getPreferredParentEui64(&address);
-    if (packetfunctions_writeAddress(&msg, &address, OW_BIG_ENDIAN) == E_FAIL) {
-        openqueue_freePacketBuffer(msg);
-        return;
-    }
-    prefix = idmanager_getMyID(ADDR_PREFIX);
-    if (packetfunctions_writeAddress(&msg, prefix, OW_BIG_ENDIAN) == E_FAIL) {
-        openqueue_freePacketBuffer(msg);
-        return;
+    if (storing) {
+        // my parent is the next hop of the routes, no parent address (rfc6550#section-6.7.8)
+        icmpv6rpl_vars.dao_transit.optionLength = sizeof(icmpv6rpl_dao_transit_ht) - 2;
+    } else {
+        if (packetfunctions_writeAddress(&msg, &parent, OW_BIG_ENDIAN) == E_FAIL) {
+            openqueue_freePacketBuffer(msg);
+            return;
+        }
+        if (packetfunctions_writeAddress(&msg, prefix, OW_BIG_ENDIAN) == E_FAIL) {
+            openqueue_freePacketBuffer(msg);
+            return;
+        }
+        // update transit info fields
+        // from rfc6550 p.55 -- Variable, depending on whether or not the DODAG ParentAddress subfield is present.
+        // poipoi xv: it is not very clear if this includes all fields in the header. or as target info 2 bytes are removed.
+        // using the same pattern as in target information.
+        icmpv6rpl_vars.dao_transit.optionLength = LENGTH_ADDR128b + sizeof(icmpv6rpl_dao_transit_ht) - 2;
     }
-    // update transit info fields
-    // from rfc6550 p.55 -- Variable, depending on whether or not the DODAG ParentAddress subfield is present.
-    // poipoi xv: it is not very clear if this includes all fields in the header. or as target info 2 bytes are removed.
-    // using the same pattern as in target information.
-    icmpv6rpl_vars.dao_transit.optionLength = LENGTH_ADDR128b + sizeof(icmpv6rpl_dao_transit_ht) - 2;
     icmpv6rpl_vars.dao_transit.PathControl = 0; //todo. this is to set the preference of this parent.
     icmpv6rpl_vars.dao_transit.type = OPTION_TRANSIT_INFORMATION_TYPE;
+    if (newPath) {
+        icmpv6rpl_vars.dao_transit.PathSequence++; //increment path sequence.
+    }
 
     // write transit info in packet
     if (packetfunctions_reserveHeader(&msg, sizeof(icmpv6rpl_dao_transit_ht)) == E_FAIL) {
@@ -952,60 +1362,69 @@ void sendDAO(void) {
     One or more Transit Information options MUST be preceded by one or
     more RPL Target options.
     */
-    numTargetParents = 0;
-    for (nbrIdx = 0; nbrIdx < MAXNUMNEIGHBORS; nbrIdx++) {
-        if ((neighbors_isNeighborWithHigherDAGrank(nbrIdx)) == TRUE) {
-            // this neighbor is of higher DAGrank as I am. so it is my child
+    numTargetParents = icmpv6rpl_getDAOTargets(targets);
+    for (i = 0; i < numTargetParents; i++) {
+        // write it's address in DAO RFC6550 page 80 check point 1.
+        neighbors_getNeighborEui64(&address, ADDR_64B, targets[i]);
+        if (packetfunctions_writeAddress(&msg, &address, OW_BIG_ENDIAN) == E_FAIL) {
+            openqueue_freePacketBuffer(msg);
+            return;
+        }
+        prefix = idmanager_getMyID(ADDR_PREFIX);
+        if (packetfunctions_writeAddress(&msg, prefix, OW_BIG_ENDIAN) == E_FAIL) {
+            openqueue_freePacketBuffer(msg);
+            return;
+        }
+        if (icmpv6rpl_writeDAOTarget(&msg) == E_FAIL) {
+            openqueue_freePacketBuffer(msg);
+            return;
+        }
+    }
 
-            // write it's address in DAO RFC6550 page 80 check point 1.
-            neighbors_getNeighborEui64(&address, ADDR_64B, nbrIdx);
-            if (packetfunctions_writeAddress(&msg, &address, OW_BIG_ENDIAN) == E_FAIL) {
-                openqueue_freePacketBuffer(msg);
-                return;
-            }
-            prefix = idmanager_getMyID(ADDR_PREFIX);
-            if (packetfunctions_writeAddress(&msg, prefix, OW_BIG_ENDIAN) == E_FAIL) {
-                openqueue_freePacketBuffer(msg);
-                return;
-            }
+    // a retransmission advertises the same routes as the last DAO
+    routeStart = newPath ? icmpv6rpl_vars.daoRouteNext : icmpv6rpl_vars.daoRouteStart;
+    route = routeStart;
+    if (storing) {
+        // my own address
+        if (
+                packetfunctions_writeAddress(&msg, idmanager_getMyID(ADDR_64B), OW_BIG_ENDIAN) == E_FAIL ||
+                packetfunctions_writeAddress(&msg, prefix, OW_BIG_ENDIAN) == E_FAIL ||
+                icmpv6rpl_writeDAOTarget(&msg) == E_FAIL
+                ) {
+            openqueue_freePacketBuffer(msg);
+            return;
+        }
 
-            // update target info fields
-            // from rfc6550 p.55 -- Variable, length of the option in octets excluding the Type and Length fields.
-            // poipoi xv: assuming that type and length fields refer to the 2 first bytes of the header
-            icmpv6rpl_vars.dao_target.optionLength =
-                    LENGTH_ADDR128b + sizeof(icmpv6rpl_dao_target_ht) - 2; //no header type and length
-            icmpv6rpl_vars.dao_target.type = OPTION_TARGET_INFORMATION_TYPE;
-            icmpv6rpl_vars.dao_target.flags = 0;       //must be 0
-            icmpv6rpl_vars.dao_target.prefixLength = 128; //128 leading bits  -- full address.
-
-            // write transit info in packet
-            if (packetfunctions_reserveHeader(&msg, sizeof(icmpv6rpl_dao_target_ht)) == E_FAIL) {
-                openqueue_freePacketBuffer(msg);
-                return;
+        // the targets of my descendants, as many as fit
+        numRoutes = 0;
+        while (route < ROUTINGTABLE_SIZE && numRoutes < MAX_DAO_TARGETS) {
+            if (routingtable_getTarget(route, &address)) {
+                if (
+                        packetfunctions_writeAddress(&msg, &address, OW_BIG_ENDIAN) == E_FAIL ||
+                        icmpv6rpl_writeDAOTarget(&msg) == E_FAIL
+                        ) {
+                    openqueue_freePacketBuffer(msg);
+                    return;
+                }
+                numRoutes++;
             }
-            memcpy(
-                    ((icmpv6rpl_dao_target_ht *) (msg->payload)),
-                    &(icmpv6rpl_vars.dao_target),
-                    sizeof(icmpv6rpl_dao_target_ht)
-            );
-
-            // remember I found it
-            numTargetParents++;
+            route++;
+        }
+        while (route < ROUTINGTABLE_SIZE && routingtable_getTarget(route, &address) == FALSE) {
+            route++;
+        }
+        if (route == ROUTINGTABLE_SIZE) {
+            // all routes advertised
+            route = 0;
         }
-        //limit to MAX_TARGET_PARENTS the number of DAO target addresses to send
-        //section 8.2.1 pag 67 RFC6550 -- using a subset
-        // poipoi TODO base selection on ETX rather than first X.
-        if (numTargetParents >= MAX_TARGET_PARENTS) break;
     }
 
-
     // stop here if no parents found
     if (numTransitParents == 0) {
         openqueue_freePacketBuffer(msg);
         return;
     }
 
-    icmpv6rpl_vars.dao_transit.PathSequence++; //increment path sequence.
     // if you get here, you will send a DAO
 
 
@@ -1014,12 +1433,18 @@ void sendDAO(void) {
         openqueue_freePacketBuffer(msg);
         return;
     }
-    icmpv6rpl_vars.dao.DAOSequence++;
+    if (newPath) {
+        icmpv6rpl_vars.dao.DAOSequence++;
+    }
     memcpy(
             ((icmpv6rpl_dao_ht *) (msg->payload)),
             &(icmpv6rpl_vars.dao),
             sizeof(icmpv6rpl_dao_ht)
     );
+    if (storing == FALSE) {
+        // only a parent in storing mode acknowledges DAOs
+        ((icmpv6rpl_dao_ht *) (msg->payload))->K_D_flags &= ~(K_DAO_MASK);
+    }
 
     //=== ICMPv6 header
     if (packetfunctions_reserveHeader(&msg, sizeof(ICMPv6_ht)) == E_FAIL) {
@@ -1028,12 +1453,28 @@ void sendDAO(void) {
     }
     ((ICMPv6_ht *) (msg->payload))->type = msg->l4_sourcePortORicmpv6Type;
     ((ICMPv6_ht *) (msg->payload))->code = IANA_ICMPv6_RPL_DAO;
+    msg->l4_payload = msg->payload;
     packetfunctions_calculateChecksum(msg, (uint8_t * ) & (((ICMPv6_ht *) (msg->payload))->checksum)); //call last
 
     //===== send
     if (icmpv6_send(msg) == E_SUCCESS) {
         icmpv6rpl_vars.busySendingDAO = TRUE;
         icmpv6rpl_vars.daoSent = TRUE;
+
+        // remember what I advertised
+        icmpv6rpl_vars.daoTimerCounter = 0;
+        icmpv6rpl_vars.daoRouteStart = routeStart;
+        icmpv6rpl_vars.daoRouteNext = route;
+        icmpv6rpl_vars.daoPending = (route != 0);
+        icmpv6rpl_vars.daoAckPending = RPL_DAO_ACK && storing;
+        if (newPath) {
+            icmpv6rpl_vars.daoRetries = 0;
+            memcpy(&icmpv6rpl_vars.daoParent, &parent, sizeof(open_addr_t));
+            for (i = 0; i < numTargetParents; i++) {
+                neighbors_getNeighborEui64(&icmpv6rpl_vars.daoTargets[i], ADDR_64B, targets[i]);
+            }
+            icmpv6rpl_vars.numDaoTargets = numTargetParents;
+        }
 #ifdef SCUM_DEBUG
         printf("DAO sent\r\n");
 #endif
@@ -1042,9 +1483,180 @@ void sendDAO(void) {
     }
 }
 
+/**
+\brief Indicate I just received a RPL DAO-ACK.
+
+\param[in] msg The received message with msg->payload pointing to the DAO-ACK
+   header.
+*/
+void icmpv6rpl_indicateRxDAOAck(OpenQueueEntry_t *msg) {
+
+    if (msg->length < (int16_t) sizeof(icmpv6rpl_dao_ack_ht)) {
+        return;
+    }
+    if (
+            icmpv6rpl_vars.daoAckPending &&
+            ((icmpv6rpl_dao_ack_ht *) (msg->payload))->DAOSequence == icmpv6rpl_vars.dao.DAOSequence
+            ) {
+        // my parent got my last DAO, a rejection is not retried before the next refresh either
+        icmpv6rpl_vars.daoAckPending = FALSE;
+        icmpv6rpl_vars.daoRetries = 0;
+    }
+}
+
+/**
+\brief Indicate I just received a RPL DAO from a child, in storing mode.
+
+The 128-bit targets it advertises are routed through that child, for the
+lifetime of its transit option. A new target is advertised in my own DAO.
+
+\param[in] msg The received message with msg->payload pointing to the DAO
+   header.
+*/
+void icmpv6rpl_indicateRxDAO(OpenQueueEntry_t *msg) {
+    uint8_t nextHop;
+    uint8_t *current;
+    uint8_t optionsLen;
+    uint8_t optionLen;
+    uint8_t headerLen;
+    uint8_t DAOSequence;
+    bool ackRequested;
+    uint32_t lifetime;
+    open_addr_t target;
+
+    // the routes go through the neighbor which sent the DAO, never through my parent
+    nextHop = neighbors_getNeighborIndex(&(msg->l2_nextORpreviousHop));
+    if (nextHop == MAXNUMNEIGHBORS || icmpv6rpl_isPreferredParent(&(msg->l2_nextORpreviousHop))) {
+        return;
+    }
+
+    // skip the DAO header, the DODAGID is only present with the D flag
+    headerLen = sizeof(icmpv6rpl_dao_ht);
+    if (msg->length < (int16_t) (headerLen - sizeof(((icmpv6rpl_dao_ht *) 0)->DODAGID))) {
+        return;
+    }
+    if ((((icmpv6rpl_dao_ht *) (msg->payload))->K_D_flags & D_DAO) == 0) {
+        headerLen -= sizeof(((icmpv6rpl_dao_ht *) 0)->DODAGID);
+    }
+    if (msg->length < headerLen) {
+        return;
+    }
+    ackRequested = (((icmpv6rpl_dao_ht *) (msg->payload))->K_D_flags & (K_DAO_MASK)) != 0;
+    DAOSequence = ((icmpv6rpl_dao_ht *) (msg->payload))->DAOSequence;
+
+    // the lifetime of the transit option applies to all targets (rfc6550#section-6.7.8)
+    lifetime = ROUTINGTABLE_MAX_LIFETIME;
+    current = msg->payload + headerLen;
+    optionsLen = msg->length - headerLen;
+    while (optionsLen > 0) {
+        if (current[0] == 0) {
+            // Pad1
+            optionLen = 1;
+        } else if (optionsLen < 2 || current[1] + 2 > optionsLen) {
+            // truncated option
+            return;
+        } else {
+            optionLen = current[1] + 2;
+        }
+        if (current[0] == OPTION_TRANSIT_INFORMATION_TYPE && optionLen >= sizeof(icmpv6rpl_dao_transit_ht)) {
+            // a lifetime of 0 is a No-Path, removing the routes
+            lifetime = (uint32_t) ((icmpv6rpl_dao_transit_ht *) current)->PathLifetime * icmpv6rpl_vars.conf.lifetimeUnit;
+            if (lifetime > ROUTINGTABLE_MAX_LIFETIME) {
+                lifetime = ROUTINGTABLE_MAX_LIFETIME;
+            }
+        }
+        optionsLen -= optionLen;
+        current += optionLen;
+    }
+
+    current = msg->payload + headerLen;
+    optionsLen = msg->length - headerLen;
+    while (optionsLen > 0) {
+        optionLen = (current[0] == 0) ? 1 : current[1] + 2;
+        if (
+                current[0] == OPTION_TARGET_INFORMATION_TYPE &&
+                optionLen >= sizeof(icmpv6rpl_dao_target_ht) + LENGTH_ADDR128b &&
+                ((icmpv6rpl_dao_target_ht *) current)->prefixLength == 128
+                ) {
+            target.type = ADDR_128B;
+            memcpy(target.addr_128b, current + sizeof(icmpv6rpl_dao_target_ht), LENGTH_ADDR128b);
+            if (
+                    idmanager_isMyAddress(&target) == FALSE &&
+                    routingtable_update(&target, nextHop, (uint16_t) lifetime)
+                    ) {
+                // my parent does not know this target yet
+                icmpv6rpl_vars.daoPending = TRUE;
+            }
+        }
+        optionsLen -= optionLen;
+        current += optionLen;
+    }
+
+    if (ackRequested) {
+        icmpv6rpl_sendDAOAck(&(msg->l3_sourceAdd), DAOSequence);
+    }
+}
+
+/**
+\brief Acknowledge the DAO of a child, in storing mode.
+
+\param[in] destination The 128-bit address of that child.
+\param[in] DAOSequence The sequence number of its DAO.
+*/
+void icmpv6rpl_sendDAOAck(open_addr_t *destination, uint8_t DAOSequence) {
+    OpenQueueEntry_t *msg;
+
+    msg = openqueue_getFreePacketBuffer(COMPONENT_ICMPv6RPL);
+    if (msg == NULL) {
+        LOG_ERROR(COMPONENT_ICMPv6RPL, ERR_NO_FREE_PACKET_BUFFER, (errorparameter_t) 0, (errorparameter_t) 0);
+        return;
+    }
+
+    // take ownership
+    msg->creator = COMPONENT_ICMPv6RPL;
+    msg->owner = COMPONENT_ICMPv6RPL;
+
+    // set transport information
+    msg->l4_protocol = IANA_ICMPv6;
+    msg->l4_sourcePortORicmpv6Type = IANA_ICMPv6_RPL;
+    memcpy(&(msg->l3_destinationAdd), destination, sizeof(open_addr_t));
+
+    //=== DAO-ACK header
+    if (packetfunctions_reserveHeader(&msg, sizeof(icmpv6rpl_dao_ack_ht)) == E_FAIL) {
+        openqueue_freePacketBuffer(msg);
+        return;
+    }
+    ((icmpv6rpl_dao_ack_ht *) (msg->payload))->rplinstanceId = icmpv6rpl_vars.dao.rplinstanceId;
+    ((icmpv6rpl_dao_ack_ht *) (msg->payload))->D_reserved = 0;
+    ((icmpv6rpl_dao_ack_ht *) (msg->payload))->DAOSequence = DAOSequence;
+    ((icmpv6rpl_dao_ack_ht *) (msg->payload))->status = 0;
+
+    //=== ICMPv6 header
+    if (packetfunctions_reserveHeader(&msg, sizeof(ICMPv6_ht)) == E_FAIL) {
+        openqueue_freePacketBuffer(msg);
+        return;
+    }
+    ((ICMPv6_ht *) (msg->payload))->type = msg->l4_sourcePortORicmpv6Type;
+    ((ICMPv6_ht *) (msg->payload))->code = IANA_ICMPv6_RPL_DAO_ACK;
+    msg->l4_payload = msg->payload;
+    packetfunctions_calculateChecksum(msg, (uint8_t * ) & (((ICMPv6_ht *) (msg->payload))->checksum)); //call last
+
+    //===== send
+    if (icmpv6_send(msg) != E_SUCCESS) {
+        openqueue_freePacketBuffer(msg);
+    }
+}
+
 bool icmpv6rpl_daoSent(void) {
     if (idmanager_getIsDAGroot() == TRUE) {
         return TRUE;
     }
     return icmpv6rpl_vars.daoSent;
 }
+
+/**
+\brief Whether the DODAG I joined runs in storing mode.
+*/
+bool icmpv6rpl_isStoringMode(void) {
+    return (icmpv6rpl_vars.dio.rplOptions & MOP_DIO_MASK) == MOP_DIO_STORING;
+}
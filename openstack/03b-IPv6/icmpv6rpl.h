@@ -8,17 +8,43 @@
 \{
 */
 
+#include "config.h"
 #include "opentimers.h"
+#include "trickle.h"
 
 //=========================== define ==========================================
 
 #define DIO_PERIOD             10000   // in miliseconds
 #define DAO_PERIOD             60000   // in miliseconds
-
+#define RPL_TIMER_SLACK          100   // in miliseconds, how early the DIO/DAO timers may fire
+#define DAO_ACK_TIMEOUT         4000   // in miliseconds, before the first DAO retransmission (doubled at each retry)
+#define DAO_MAX_RETRIES            4   // DAO retransmissions before waiting for the next refresh
+
+// in storing mode, request a DAO-ACK from my parent and retransmit the DAOs it does not acknowledge
+#ifndef RPL_DAO_ACK
+#define RPL_DAO_ACK                0
+#endif
+
+// in storing mode, descendants advertised per DAO, the next ones go in the following DAOs
+#if OPENWSN_6LO_FRAGMENTATION_C
+#define MAX_DAO_TARGETS            ROUTINGTABLE_SIZE
+#else
+#define MAX_DAO_TARGETS            2
+#endif
+
+#if RPL_STORING_MODE
+// Storing Mode of Operation with no multicast support (2)
+#define MOP_DIO_A                 0<<5
+#define MOP_DIO_B                 1<<4
+#define MOP_DIO_C                 0<<3
+#else
 // Non-Storing Mode of Operation (1)
 #define MOP_DIO_A                 0<<5
 #define MOP_DIO_B                 0<<4
 #define MOP_DIO_C                 1<<3
+#endif
+#define MOP_DIO_MASK              (7<<3)
+#define MOP_DIO_STORING           (2<<3)
 // least preferred (0)
 #define PRF_DIO_A                 0<<2
 #define PRF_DIO_B                 0<<1
@@ -33,7 +59,8 @@
 #define FLAG_DAO_E                0<<4
 #define FLAG_DAO_F                0<<5
 #define D_DAO                     1<<6
-#define K_DAO                     0<<7
+#define K_DAO                     RPL_DAO_ACK<<7
+#define K_DAO_MASK                1<<7
 
 #define E_DAO_Transit_Info        0<<7
 
@@ -57,6 +84,17 @@
 #define RPL_OPTION_PIO 0x8
 #define RPL_OPTION_CONFIG 0x4
 
+// objective code points, IANA "Objective Code Point" registry
+#define OCP_OF0                   0
+#define OCP_MRHOF                 1
+#ifndef RPL_OCP
+#define RPL_OCP                   OCP_OF0   // objective function advertised by the DAGroot
+#endif
+
+// MRHOF (RFC6719) with the ETX metric, in units of rank (RFC6719 uses units of 128 per ETX)
+#define MRHOF_MAX_LINK_METRIC         (4 * MINHOPRANKINCREASE)      // ETX 4
+#define MRHOF_PARENT_SWITCH_THRESHOLD (3 * MINHOPRANKINCREASE / 2)  // ETX 1.5
+
 // max number of parents and children to send in DAO
 //section 8.2.1 pag 67 RFC6550 -- using a subset
 #define MAX_TARGET_PARENTS        0x01
@@ -169,6 +207,31 @@ typedef struct {
 } icmpv6rpl_dao_target_ht;
 END_PACK
 
+/**
+\brief Header format of a RPL DAO-ACK packet.
+*/
+BEGIN_PACK
+typedef struct {
+    uint8_t rplinstanceId;
+    uint8_t D_reserved;
+    uint8_t DAOSequence;        ///< sequence number of the DAO being acknowledged.
+    uint8_t status;             ///< 0 accepted, 128 and above rejected.
+} icmpv6rpl_dao_ack_ht;
+END_PACK
+
+//===== objective function
+
+typedef uint16_t (*icmpv6rpl_of_getRankIncrease_cbt)(uint8_t neighborIndex);
+
+/**
+\brief An RPL objective function.
+*/
+typedef struct {
+    uint16_t OCP;                                     ///< objective code point advertised in the DODAG configuration.
+    uint16_t parentSwitchThreshold;                   ///< rank decrease needed to switch to another parent.
+    icmpv6rpl_of_getRankIncrease_cbt getRankIncrease; ///< rank increase through a neighbor, 65535 if not eligible.
+} icmpv6rpl_of_t;
+
 //=========================== module variables ================================
 
 
@@ -185,20 +248,38 @@ typedef struct {
     open_addr_t dioDestination;               ///< IPv6 destination address for DIOs.
     uint16_t dioTimerCounter;                 ///< counter to determine when to send DIO.
     opentimers_id_t timerIdDIO;               ///< ID of the timer used to send DIOs.
+    trickle_t trickleDIO;                     ///< Trickle timer pacing the DIOs.
     uint16_t dioPeriod;                       ///< dio period in seconds.
     // DAO-related
     icmpv6rpl_dao_ht dao;                     ///< pre-populated DAO packet.
     icmpv6rpl_dao_transit_ht dao_transit;     ///< pre-populated DAO "Transit Info" option header.
     icmpv6rpl_dao_target_ht dao_target;       ///< pre-populated DAO "Transit Info" option header.
     opentimers_id_t timerIdDAO;               ///< ID of the timer used to send DAOs.
-    uint16_t daoTimerCounter;                 ///< counter to determine when to send DAO.
-    uint16_t daoPeriod;                       ///< dao period in seconds.
+    uint16_t daoTimerCounter;                 ///< DAO timer ticks since the last DAO was sent.
+    uint16_t daoPeriod;                       ///< period in miliseconds at which an unchanged DAO is refreshed.
+    open_addr_t daoParent;                    ///< parent advertised in the last DAO.
+    open_addr_t daoTargets[MAX_TARGET_PARENTS]; ///< children advertised in the last DAO.
+    uint8_t numDaoTargets;                    ///< number of children advertised in the last DAO.
+    bool daoPending;                          ///< the last DAO is outdated or was lost.
+    bool daoAckPending;                       ///< waiting for the DAO-ACK of the last DAO.
+    uint8_t daoRetries;                       ///< retransmissions of the last DAO.
+    uint8_t daoRouteStart;                    ///< storing mode, first route advertised in the last DAO.
+    uint8_t daoRouteNext;                     ///< storing mode, first route to advertise in the next DAO.
     // routing table
     dagrank_t myDAGrank;                      ///< rank of this router within DAG.
     dagrank_t lowestRankInHistory;            ///< lowest Rank that the node has advertised
     uint16_t rankIncrease;                    ///< the cost of the link to the parent, in units of rank
     bool haveParent;                          ///< this router has a route to DAG root
     uint8_t ParentIndex;                      ///< index of Parent in neighbor table (iff haveParent==TRUE)
+    const icmpv6rpl_of_t *of;                 ///< objective function in use, selected by the OCP of the DODAG
+    // candidate parents
+    uint8_t candidateParents[MAXNUMNEIGHBORS];       ///< neighbor indices of the candidate parents, best first
+    uint8_t numCandidateParents;                     ///< number of candidate parents
+    dagrank_t candidateDAGrank[MAXNUMNEIGHBORS];     ///< my rank through each candidate parent, by neighbor index
+    uint16_t candidateRankIncrease[MAXNUMNEIGHBORS]; ///< link cost to each candidate parent, by neighbor index
+    bool candidateParentsValid;                      ///< FALSE until all neighbors are ranked again
+    uint32_t numFullParentSelections;                ///< parent selections which ranked all neighbors
+    uint32_t numIncrementalParentSelections;         ///< parent selections which ranked a single neighbor
     // actually only here for debug
     icmpv6rpl_dio_ht *incomingDio;            ///< keep it global to be able to debug correctly.
     icmpv6rpl_pio_t *incomingPio;             ///< pio structure incoming
@@ -236,10 +317,16 @@ void icmpv6rpl_killPreferredParent(void);
 
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void);
 
+void icmpv6rpl_indicateNeighborUpdate(uint8_t neighborIndex);
+
+void icmpv6rpl_updateCandidateParent(uint8_t neighborIndex);
+
 void icmpv6rpl_indicateRxDIO(OpenQueueEntry_t *msg);
 
 bool icmpv6rpl_daoSent(void);
 
+bool icmpv6rpl_isStoringMode(void);
+
 
 /**
 \}
@@ -0,0 +1,258 @@
+#include "opendefs.h"
+#include "routingtable.h"
+#include "idmanager.h"
+
+//=========================== variables =======================================
+
+routingtable_vars_t routingtable_vars;
+
+//=========================== prototypes ======================================
+
+bool routingtable_getInterfaceId(open_addr_t *address, uint8_t *interfaceId);
+
+uint8_t routingtable_hash(uint8_t *interfaceId);
+
+uint8_t routingtable_lookup(uint8_t *interfaceId);
+
+void routingtable_removeSlot(uint8_t slot);
+
+//=========================== public ==========================================
+
+/**
+\brief Initializes this module.
+*/
+void routingtable_init(void) {
+    uint8_t i;
+
+    memset(&routingtable_vars, 0, sizeof(routingtable_vars_t));
+    for (i = 0; i < ROUTINGTABLE_SIZE; i++) {
+        routingtable_vars.routes[i].nextHop = ROUTINGTABLE_EMPTY;
+    }
+}
+
+/**
+\brief Install, refresh or remove the route to a target.
+
+\param[in] target   The 128-bit address of the target, in my prefix.
+\param[in] nextHop  The neighbor index of the next hop towards the target.
+\param[in] lifetime The lifetime of the route in seconds, 0 to remove it.
+
+\returns TRUE if this is a new target, FALSE otherwise.
+*/
+bool routingtable_update(open_addr_t *target, uint8_t nextHop, uint16_t lifetime) {
+    uint8_t interfaceId[LENGTH_ADDR64b];
+    uint8_t slot;
+
+    if (routingtable_getInterfaceId(target, interfaceId) == FALSE) {
+        return FALSE;
+    }
+
+    slot = routingtable_lookup(interfaceId);
+    if (lifetime == 0) {
+        // No-Path
+        if (slot < ROUTINGTABLE_SIZE) {
+            routingtable_removeSlot(slot);
+        }
+        return FALSE;
+    }
+    if (lifetime > ROUTINGTABLE_MAX_LIFETIME) {
+        lifetime = ROUTINGTABLE_MAX_LIFETIME;
+    }
+    if (slot < ROUTINGTABLE_SIZE) {
+        routingtable_vars.routes[slot].nextHop = nextHop;
+        routingtable_vars.routes[slot].lifetime = lifetime;
+        return FALSE;
+    }
+
+    if (routingtable_vars.numRoutes == ROUTINGTABLE_SIZE) {
+        // no room left for this target
+        return FALSE;
+    }
+    slot = routingtable_hash(interfaceId);
+    while (routingtable_vars.routes[slot].nextHop != ROUTINGTABLE_EMPTY) {
+        slot = (slot + 1) & (ROUTINGTABLE_SIZE - 1);
+    }
+    memcpy(routingtable_vars.routes[slot].target, interfaceId, LENGTH_ADDR64b);
+    routingtable_vars.routes[slot].nextHop = nextHop;
+    routingtable_vars.routes[slot].lifetime = lifetime;
+    routingtable_vars.numRoutes++;
+    return TRUE;
+}
+
+/**
+\brief Retrieve the next hop towards a destination.
+
+\param[in]  destination The 128-bit IPv6 destination address.
+\param[out] nextHop     The neighbor index of the next hop.
+
+\returns TRUE if there is a route to that destination, FALSE otherwise.
+*/
+bool routingtable_getNextHop(open_addr_t *destination, uint8_t *nextHop) {
+    uint8_t interfaceId[LENGTH_ADDR64b];
+    uint8_t slot;
+
+    if (routingtable_vars.numRoutes == 0 || routingtable_getInterfaceId(destination, interfaceId) == FALSE) {
+        return FALSE;
+    }
+    slot = routingtable_lookup(interfaceId);
+    if (slot == ROUTINGTABLE_SIZE) {
+        return FALSE;
+    }
+    *nextHop = routingtable_vars.routes[slot].nextHop;
+    return TRUE;
+}
+
+/**
+\brief Retrieve the target of the route in a slot of the table.
+
+\param[in]  index  The slot, from 0 to ROUTINGTABLE_SIZE-1.
+\param[out] target The 128-bit address of the target.
+
+\returns TRUE if that slot holds a route, FALSE otherwise.
+*/
+bool routingtable_getTarget(uint8_t index, open_addr_t *target) {
+    if (index >= ROUTINGTABLE_SIZE || routingtable_vars.routes[index].nextHop == ROUTINGTABLE_EMPTY) {
+        return FALSE;
+    }
+    target->type = ADDR_128B;
+    memcpy(&target->addr_128b[0], idmanager_getMyID(ADDR_PREFIX)->prefix, LENGTH_ADDR64b);
+    memcpy(&target->addr_128b[8], routingtable_vars.routes[index].target, LENGTH_ADDR64b);
+    return TRUE;
+}
+
+uint8_t routingtable_getNumRoutes(void) {
+    return routingtable_vars.numRoutes;
+}
+
+/**
+\brief Remove the routes through a neighbor, before its row is reused.
+
+\param[in] nextHop The neighbor index of that neighbor.
+*/
+void routingtable_removeNextHop(uint8_t nextHop) {
+    uint8_t slot;
+
+    slot = 0;
+    while (slot < ROUTINGTABLE_SIZE && routingtable_vars.numRoutes > 0) {
+        if (routingtable_vars.routes[slot].nextHop == nextHop) {
+            // an entry of the probe sequence may have moved into this slot
+            routingtable_removeSlot(slot);
+        } else {
+            slot++;
+        }
+    }
+}
+
+/**
+\brief Take some elapsed time from the lifetimes, removing the expired routes.
+
+\param[in] elapsedMs The time elapsed since the last call, in ms.
+*/
+void routingtable_age(uint16_t elapsedMs) {
+    uint16_t elapsed;
+    uint8_t slot;
+
+    routingtable_vars.agingMs += elapsedMs;
+    if (routingtable_vars.agingMs < 1000) {
+        return;
+    }
+    elapsed = routingtable_vars.agingMs / 1000;
+    routingtable_vars.agingMs %= 1000;
+
+    for (slot = 0; slot < ROUTINGTABLE_SIZE; slot++) {
+        if (routingtable_vars.routes[slot].nextHop == ROUTINGTABLE_EMPTY) {
+            continue;
+        }
+        if (routingtable_vars.routes[slot].lifetime <= elapsed) {
+            routingtable_vars.routes[slot].lifetime = 0;
+        } else {
+            routingtable_vars.routes[slot].lifetime -= elapsed;
+        }
+    }
+
+    // removing a route may shift the following ones back, so expire them in a second pass
+    slot = 0;
+    while (slot < ROUTINGTABLE_SIZE && routingtable_vars.numRoutes > 0) {
+        if (
+                routingtable_vars.routes[slot].nextHop != ROUTINGTABLE_EMPTY &&
+                routingtable_vars.routes[slot].lifetime == 0
+                ) {
+            routingtable_removeSlot(slot);
+        } else {
+            slot++;
+        }
+    }
+}
+
+//=========================== private =========================================
+
+/**
+\brief Retrieve the interface identifier of an address in my prefix.
+*/
+bool routingtable_getInterfaceId(open_addr_t *address, uint8_t *interfaceId) {
+    if (
+            address->type != ADDR_128B ||
+            memcmp(&address->addr_128b[0], idmanager_getMyID(ADDR_PREFIX)->prefix, LENGTH_ADDR64b) != 0
+            ) {
+        return FALSE;
+    }
+    memcpy(interfaceId, &address->addr_128b[8], LENGTH_ADDR64b);
+    return TRUE;
+}
+
+uint8_t routingtable_hash(uint8_t *interfaceId) {
+    uint8_t i;
+    uint8_t hash;
+
+    hash = 0;
+    for (i = 0; i < LENGTH_ADDR64b; i++) {
+        hash = (uint8_t)((hash << 3) | (hash >> 5)) ^ interfaceId[i];
+    }
+    return hash & (ROUTINGTABLE_SIZE - 1);
+}
+
+/**
+\brief Find the slot of the route to a target.
+
+\returns The slot, or ROUTINGTABLE_SIZE if there is no route to that target.
+*/
+uint8_t routingtable_lookup(uint8_t *interfaceId) {
+    uint8_t slot;
+    uint8_t probes;
+
+    slot = routingtable_hash(interfaceId);
+    for (probes = 0; probes < ROUTINGTABLE_SIZE; probes++) {
+        if (routingtable_vars.routes[slot].nextHop == ROUTINGTABLE_EMPTY) {
+            break;
+        }
+        if (memcmp(routingtable_vars.routes[slot].target, interfaceId, LENGTH_ADDR64b) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & (ROUTINGTABLE_SIZE - 1);
+    }
+    return ROUTINGTABLE_SIZE;
+}
+
+/**
+\brief Free a slot, shifting back the following entries of its probe sequence.
+*/
+void routingtable_removeSlot(uint8_t slot) {
+    uint8_t freeSlot;
+    uint8_t home;
+
+    freeSlot = slot;
+    while (TRUE) {
+        slot = (slot + 1) & (ROUTINGTABLE_SIZE - 1);
+        if (routingtable_vars.routes[slot].nextHop == ROUTINGTABLE_EMPTY || slot == freeSlot) {
+            break;
+        }
+        home = routingtable_hash(routingtable_vars.routes[slot].target);
+        // the entry can move back only if its home slot is not cyclically in (freeSlot, slot]
+        if (((slot - home) & (ROUTINGTABLE_SIZE - 1)) >= ((slot - freeSlot) & (ROUTINGTABLE_SIZE - 1))) {
+            memcpy(&routingtable_vars.routes[freeSlot], &routingtable_vars.routes[slot], sizeof(routingtable_entry_t));
+            freeSlot = slot;
+        }
+    }
+    routingtable_vars.routes[freeSlot].nextHop = ROUTINGTABLE_EMPTY;
+    routingtable_vars.numRoutes--;
+}
@@ -0,0 +1,63 @@
+#ifndef OPENWSN_ROUTINGTABLE_H
+#define OPENWSN_ROUTINGTABLE_H
+
+/**
+\addtogroup IPv6
+\{
+\addtogroup RoutingTable
+\{
+*/
+
+#include "config.h"
+#include "opendefs.h"
+
+//=========================== define ==========================================
+
+#if (ROUTINGTABLE_SIZE & (ROUTINGTABLE_SIZE - 1)) != 0 || ROUTINGTABLE_SIZE > 128
+#error "ROUTINGTABLE_SIZE must be a power of 2, at most 128"
+#endif
+
+#define ROUTINGTABLE_EMPTY          0xff  // next hop of a free route
+#define ROUTINGTABLE_MAX_LIFETIME   180   // in seconds, longest lifetime of a route (3 DAO refresh periods)
+
+//=========================== typedef =========================================
+
+/**
+\brief A route to a target in my prefix, kept by its interface identifier.
+*/
+typedef struct {
+    uint8_t target[LENGTH_ADDR64b];   // interface identifier of the target
+    uint8_t nextHop;                  // neighbor index of the next hop, ROUTINGTABLE_EMPTY if free
+    uint16_t lifetime;                // seconds before the route expires
+} routingtable_entry_t;
+
+//=========================== module variables ================================
+
+typedef struct {
+    routingtable_entry_t routes[ROUTINGTABLE_SIZE]; // open addressing, probed from the hash of the target
+    uint8_t numRoutes;                              // number of routes in use
+    uint16_t agingMs;                               // elapsed time not yet taken from the lifetimes, in ms
+} routingtable_vars_t;
+
+//=========================== prototypes ======================================
+
+void routingtable_init(void);
+
+bool routingtable_update(open_addr_t *target, uint8_t nextHop, uint16_t lifetime);
+
+bool routingtable_getNextHop(open_addr_t *destination, uint8_t *nextHop);
+
+bool routingtable_getTarget(uint8_t index, open_addr_t *target);
+
+uint8_t routingtable_getNumRoutes(void);
+
+void routingtable_removeNextHop(uint8_t nextHop);
+
+void routingtable_age(uint16_t elapsedMs);
+
+/**
+\}
+\}
+*/
+
+#endif /* OPENWSN_ROUTINGTABLE_H */
@@ -20,7 +20,7 @@ void idmanager_init(void) {
     // reset local variables
     memset(&idmanager_vars, 0, sizeof(idmanager_vars_t));
     // this is used to not wakeup in non-activeslot
-    idmanager_vars.slotSkip = FALSE;
+    idmanager_vars.slotSkip = IEEE802154E_SLOT_SKIP;
 
     // isDAGroot
 #if DAGROOT
@@ -7,19 +7,50 @@
 #include "radio.h"
 #include "IEEE802154_security.h"
 #include "sixtop.h"
+#include "scheduler.h"
 
 //=========================== defination =====================================
 
-#define HIGH_PRIORITY_QUEUE_ENTRY 5
+#define HIGH_PRIORITY_TASK_ENTRY  3
 
 //=========================== variables =======================================
 
 openqueue_vars_t openqueue_vars;
 
+// entries of the queue reserved to each traffic class
+const uint8_t openqueue_reserved[OPENQUEUE_NUM_CLASSES] = {
+        OPENQUEUE_RESERVED(OPENQUEUE_RESERVED_CONTROL),
+        OPENQUEUE_RESERVED(OPENQUEUE_RESERVED_RPL),
+        OPENQUEUE_RESERVED(OPENQUEUE_RESERVED_FORWARDED),
+        OPENQUEUE_RESERVED(OPENQUEUE_RESERVED_LOCAL)
+};
+
 //=========================== prototypes ======================================
 
 void openqueue_reset_entry(OpenQueueEntry_t *entry);
 
+uint8_t openqueue_getEntryIndex(OpenQueueEntry_t *entry);
+
+OpenQueueEntry_t* openqueue_getEntry(uint8_t index);
+
+uint8_t openqueue_getMacTxList(open_addr_t *nextHop);
+
+void openqueue_macTxLink(uint8_t index);
+
+void openqueue_macTxUnlink(uint8_t index);
+
+uint8_t openqueue_macTxNext(uint8_t list, uint8_t index);
+
+uint8_t openqueue_getClass(uint8_t creator);
+
+void openqueue_updateClass(uint8_t index, uint8_t creator);
+
+bool openqueue_isAdmitted(uint8_t trafficClass, uint8_t numNewEntries);
+
+void openqueue_countDrop(uint8_t trafficClass);
+
+void openqueue_releaseEntry(uint8_t index);
+
 #if OPENWSN_6LO_FRAGMENTATION_C
 void openqueue_reset_big_entry(OpenQueueBigEntry_t *entry);
 #endif
@@ -33,6 +64,11 @@ void openqueue_reset_big_entry(OpenQueueBigEntry_t *entry);
 */
 void openqueue_init() {
     uint8_t i;
+
+    memset(&openqueue_vars.macTxHead[0], OPENQUEUE_NO_ENTRY, sizeof(openqueue_vars.macTxHead));
+    memset(&openqueue_vars.macTxList[0], OPENQUEUE_NO_ENTRY, sizeof(openqueue_vars.macTxList));
+    memset(&openqueue_vars.sixtopContext[0], 0, sizeof(openqueue_vars.sixtopContext));
+
     for (i = 0; i < QUEUELENGTH; i++) {
         openqueue_reset_entry(&(openqueue_vars.queue[i]));
     }
@@ -42,6 +78,23 @@ void openqueue_init() {
         openqueue_reset_big_entry(&(openqueue_vars.big_queue[i]));
     }
 #endif
+
+    // all entries are free, the first one allocated is the first of the queue
+    memset(&openqueue_vars.entryClass[0], OPENQUEUE_CLASS_NONE, sizeof(openqueue_vars.entryClass));
+    memset(&openqueue_vars.numInClass[0], 0, sizeof(openqueue_vars.numInClass));
+    memset(&openqueue_vars.numDrops[0], 0, sizeof(openqueue_vars.numDrops));
+    openqueue_vars.freeHead = OPENQUEUE_NO_ENTRY;
+    for (i = QUEUELENGTH; i > 0; i--) {
+        openqueue_vars.freeNext[i - 1] = openqueue_vars.freeHead;
+        openqueue_vars.freeHead = i - 1;
+    }
+#if OPENWSN_6LO_FRAGMENTATION_C
+    openqueue_vars.bigFreeHead = OPENQUEUE_NO_ENTRY;
+    for (i = QUEUELENGTH + BIGQUEUELENGTH; i > QUEUELENGTH; i--) {
+        openqueue_vars.freeNext[i - 1] = openqueue_vars.bigFreeHead;
+        openqueue_vars.bigFreeHead = i - 1;
+    }
+#endif
 }
 
 /**
@@ -63,6 +116,25 @@ bool debugPrint_queue() {
     return TRUE;
 }
 
+#if OPENQUEUE_DEBUG_ENABLE
+/**
+\brief Print the occupancy and the drop counters of each traffic class.
+
+\returns TRUE if this function printed something, FALSE otherwise.
+*/
+bool debugPrint_queueClasses() {
+    debugOpenQueueClasses_t output;
+    uint8_t c;
+
+    for (c = 0; c < OPENQUEUE_NUM_CLASSES; c++) {
+        output.numInClass[c] = openqueue_vars.numInClass[c];
+        output.numDrops[c] = openqueue_vars.numDrops[c];
+    }
+    openserial_printStatus(STATUS_QUEUECLASSES, (uint8_t * ) & output, sizeof(debugOpenQueueClasses_t));
+    return TRUE;
+}
+#endif
+
 //======= called by any component
 
 /**
@@ -79,6 +151,7 @@ get a new packet buffer to start creating a new packet.
 */
 OpenQueueEntry_t* openqueue_getFreePacketBuffer(uint8_t creator) {
     uint8_t i;
+    uint8_t trafficClass;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
@@ -90,23 +163,37 @@ OpenQueueEntry_t* openqueue_getFreePacketBuffer(uint8_t creator) {
 
     // if you get here, I will try to allocate a buffer for you
 
-    // if there is no space left for high priority queue, don't reserve
-    if (openqueue_isHighPriorityEntryEnough() == FALSE && creator > COMPONENT_SIXTOP_RES) {
+    // don't take an entry reserved to another traffic class
+    trafficClass = openqueue_getClass(creator);
+    if (openqueue_isAdmitted(trafficClass, 1) == FALSE) {
+        openqueue_countDrop(trafficClass);
         ENABLE_INTERRUPTS();
         return NULL;
     }
 
-    // walk through queue and find free entry
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].owner == COMPONENT_NULL) {
-            openqueue_vars.queue[i].creator = creator;
-            openqueue_vars.queue[i].owner = COMPONENT_OPENQUEUE;
-            ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
-        }
+#if SCHEDULER_OVERFLOW_POLICY_ENABLE
+    // if the scheduler is running out of task containers, throttle low priority creators
+    if (scheduler_getNumTasksFree() < HIGH_PRIORITY_TASK_ENTRY && creator > COMPONENT_SIXTOP_RES) {
+        openqueue_countDrop(trafficClass);
+        ENABLE_INTERRUPTS();
+        return NULL;
+    }
+#endif
+
+    // take the last freed entry
+    i = openqueue_vars.freeHead;
+    if (i == OPENQUEUE_NO_ENTRY) {
+        openqueue_countDrop(trafficClass);
+        ENABLE_INTERRUPTS();
+        return NULL;
     }
+    openqueue_vars.freeHead = openqueue_vars.freeNext[i];
+
+    openqueue_vars.queue[i].creator = creator;
+    openqueue_vars.queue[i].owner = COMPONENT_OPENQUEUE;
+    openqueue_updateClass(i, creator);
     ENABLE_INTERRUPTS();
-    return NULL;
+    return &openqueue_vars.queue[i];
 }
 
 /**
@@ -123,41 +210,31 @@ owerror_t openqueue_freePacketBuffer(OpenQueueEntry_t *pkt) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
+    // recover the entry from its address
+    i = openqueue_getEntryIndex(pkt);
+    if (i >= QUEUELENGTH + BIGQUEUELENGTH || openqueue_getEntry(i) != pkt) {
+        // log the error
+        LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_ERROR, (errorparameter_t) 0, (errorparameter_t) 0);
+        ENABLE_INTERRUPTS();
+        return E_FAIL;
+    }
+
+    if (pkt->owner == COMPONENT_NULL) {
+        // log the error
+        LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_UNUSED, (errorparameter_t) 0, (errorparameter_t) 0);
+    }
+
 #if OPENWSN_6LO_FRAGMENTATION_C
     if (pkt->is_big_packet) {
-        for (i = 0; i < BIGQUEUELENGTH; i++) {
-            if ((OpenQueueBigEntry_t *) pkt == &openqueue_vars.big_queue[i]) {
-                if (openqueue_vars.big_queue[i].standard_entry.owner == COMPONENT_NULL) {
-                    // log the error
-                    LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_UNUSED,(errorparameter_t) 0,(errorparameter_t) 0);
-                }
-
-                openqueue_reset_big_entry((OpenQueueBigEntry_t *) pkt);
-                ENABLE_INTERRUPTS();
-                return E_SUCCESS;
-            }
-        }
+        openqueue_reset_big_entry((OpenQueueBigEntry_t *) pkt);
     } else {
 #endif
-        for (i = 0; i < QUEUELENGTH; i++) {
-            if (&openqueue_vars.queue[i] == pkt) {
-                if (openqueue_vars.queue[i].owner == COMPONENT_NULL) {
-                    // log the error
-                    LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_UNUSED, (errorparameter_t) 0, (errorparameter_t) 0);
-                }
-                openqueue_reset_entry(&(openqueue_vars.queue[i]));
-                ENABLE_INTERRUPTS();
-                return E_SUCCESS;
-            }
-        }
+        openqueue_reset_entry(pkt);
 #if OPENWSN_6LO_FRAGMENTATION_C
     }
 #endif
-
-    // log the error
-    LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_ERROR, (errorparameter_t) 0, (errorparameter_t) 0);
     ENABLE_INTERRUPTS();
-    return E_FAIL;
+    return E_SUCCESS;
 }
 
 #if OPENWSN_6LO_FRAGMENTATION_C
@@ -173,21 +250,22 @@ OpenQueueEntry_t* openqueue_getFreeBigPacketBuffer(uint8_t creator) {
         return NULL;
     }
 
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
-        if (openqueue_vars.big_queue[i].standard_entry.owner == COMPONENT_NULL) {
-
-            openqueue_vars.big_queue[i].standard_entry.creator = creator;
-            openqueue_vars.big_queue[i].standard_entry.owner = COMPONENT_OPENQUEUE;
-            openqueue_vars.big_queue[i].standard_entry.is_big_packet = TRUE;
-
-            ENABLE_INTERRUPTS();
-            return &openqueue_vars.big_queue[i].standard_entry;
-
-        }
+    // take the last freed entry
+    i = openqueue_vars.bigFreeHead;
+    if (i == OPENQUEUE_NO_ENTRY) {
+        openqueue_countDrop(openqueue_getClass(creator));
+        ENABLE_INTERRUPTS();
+        return NULL;
     }
+    openqueue_vars.bigFreeHead = openqueue_vars.freeNext[i];
+    i -= QUEUELENGTH;
+
+    openqueue_vars.big_queue[i].standard_entry.creator = creator;
+    openqueue_vars.big_queue[i].standard_entry.owner = COMPONENT_OPENQUEUE;
+    openqueue_vars.big_queue[i].standard_entry.is_big_packet = TRUE;
 
     ENABLE_INTERRUPTS();
-    return NULL;
+    return &openqueue_vars.big_queue[i].standard_entry;
 }
 #endif
 
@@ -220,6 +298,90 @@ void openqueue_removeAllCreatedBy(uint8_t creator) {
     ENABLE_INTERRUPTS();
 }
 
+/**
+\brief Change the creator of a packet buffer.
+
+Use this rather than writing the creator field of an allocated packet, it moves
+the entry to the traffic class of its new creator.
+
+\param pkt     The packet buffer.
+\param creator The identifier of the new creator, taken in COMPONENT_*.
+*/
+void openqueue_setCreator(OpenQueueEntry_t *pkt, uint8_t creator) {
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    pkt->creator = creator;
+    openqueue_updateClass(openqueue_getEntryIndex(pkt), creator);
+
+    ENABLE_INTERRUPTS();
+}
+
+/**
+\brief Check that a packet does not hold an entry reserved to another class.
+
+To be called after a packet changed class with openqueue_setCreator(), e.g. a
+received frame which is relayed. The caller is expected to drop the packet when
+this returns FALSE, which is counted as a drop of its traffic class.
+
+\param pkt The packet buffer.
+
+\returns TRUE if the traffic class of the packet is within its quota.
+*/
+bool openqueue_isWithinQuota(OpenQueueEntry_t *pkt) {
+    uint8_t index;
+    uint8_t trafficClass;
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    index = openqueue_getEntryIndex(pkt);
+    if (index >= QUEUELENGTH) {
+        // big packet buffers are not subject to quotas
+        ENABLE_INTERRUPTS();
+        return TRUE;
+    }
+
+    trafficClass = openqueue_vars.entryClass[index];
+    if (openqueue_isAdmitted(trafficClass, 0) == FALSE) {
+        openqueue_countDrop(trafficClass);
+        ENABLE_INTERRUPTS();
+        return FALSE;
+    }
+    ENABLE_INTERRUPTS();
+    return TRUE;
+}
+
+/**
+\brief Attach a 6P context to a packet buffer.
+
+The cell lists and the 6P fields needed when a 6P response is sent are kept in
+a small separate pool rather than in every packet buffer. The context is
+released together with the packet buffer.
+
+\param pkt The packet buffer, usually a 6P response.
+
+\returns E_SUCCESS when a context is attached to pkt->l2_sixtop.
+\returns E_FAIL when all the contexts are in use.
+*/
+owerror_t openqueue_attachSixtopContext(OpenQueueEntry_t *pkt) {
+    uint8_t i;
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    for (i = 0; i < SIXTOPCONTEXTLENGTH; i++) {
+        if (openqueue_vars.sixtopContext[i].isUsed == FALSE) {
+            memset(&openqueue_vars.sixtopContext[i], 0, sizeof(OpenQueueSixtopContext_t));
+            openqueue_vars.sixtopContext[i].isUsed = TRUE;
+            openqueue_vars.sixtopContext[i].command = IANA_6TOP_CMD_NONE;
+            pkt->l2_sixtop = &openqueue_vars.sixtopContext[i];
+            ENABLE_INTERRUPTS();
+            return E_SUCCESS;
+        }
+    }
+    ENABLE_INTERRUPTS();
+    return E_FAIL;
+}
+
 //======= called by RES
 
 OpenQueueEntry_t* openqueue_sixtopGetSentPacket() {
@@ -266,15 +428,16 @@ OpenQueueEntry_t* openqueue_sixtopGetReceivedPacket() {
 uint8_t openqueue_getNum6PReq(open_addr_t *neighbor) {
 
     uint8_t i;
+    uint8_t list;
     uint8_t num6Prequest;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
     num6Prequest = 0;
-    for (i = 0; i < QUEUELENGTH; i++) {
+    list = openqueue_getMacTxList(neighbor);
+    for (i = openqueue_macTxNext(list, OPENQUEUE_NO_ENTRY); i < QUEUELENGTH; i = openqueue_macTxNext(list, i)) {
         if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
                 openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_REQUEST &&
                 packetfunctions_sameAddress(neighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
@@ -289,19 +452,21 @@ uint8_t openqueue_getNum6PReq(open_addr_t *neighbor) {
 uint8_t openqueue_getNum6PResp() {
 
     uint8_t i;
+    uint8_t list;
     uint8_t num6Presponse;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
     num6Presponse = 0;
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-                openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
-                openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_RESPONSE
-                ) {
-            num6Presponse += 1;
+    for (list = 0; list < OPENQUEUE_NUM_MACTX_LISTS; list++) {
+        for (i = openqueue_macTxNext(list, OPENQUEUE_NO_ENTRY); i < QUEUELENGTH; i = openqueue_macTxNext(list, i)) {
+            if (
+                    openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
+                    openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_RESPONSE
+                    ) {
+                num6Presponse += 1;
+            }
         }
     }
     ENABLE_INTERRUPTS();
@@ -311,13 +476,17 @@ uint8_t openqueue_getNum6PResp() {
 void openqueue_remove6PrequestToNeighbor(open_addr_t *neighbor) {
 
     uint8_t i;
+    uint8_t next;
+    uint8_t list;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    for (i = 0; i < QUEUELENGTH; i++) {
+    list = openqueue_getMacTxList(neighbor);
+    for (i = openqueue_macTxNext(list, OPENQUEUE_NO_ENTRY); i < QUEUELENGTH; i = next) {
+        // resetting the entry unlinks it, get its successor first
+        next = openqueue_macTxNext(list, i);
         if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
                 openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_REQUEST &&
                 packetfunctions_sameAddress(neighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
@@ -328,37 +497,33 @@ void openqueue_remove6PrequestToNeighbor(open_addr_t *neighbor) {
     ENABLE_INTERRUPTS();
 }
 
-//======= called by IEEE80215E
+/**
+\brief Hand a packet over to the MAC layer.
 
-bool openqueue_isHighPriorityEntryEnough() {
-    uint8_t i;
-    uint8_t numberOfEntry;
+The packet becomes owned by COMPONENT_SIXTOP_TO_IEEE802154E, and is indexed by
+its next hop, so the MAC only looks at the packets to the neighbor of the
+current cell. A packet leaving that owner is dropped from the index lazily.
+
+\param pkt The packet to transmit, its l2_nextORpreviousHop already set.
+*/
+void openqueue_macPutPacket(OpenQueueEntry_t *pkt) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    numberOfEntry = 0;
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].creator > COMPONENT_SIXTOP_RES) {
-            numberOfEntry++;
-        }
-    }
+    pkt->owner = COMPONENT_SIXTOP_TO_IEEE802154E;
+    openqueue_macTxLink(openqueue_getEntryIndex(pkt));
 
-    if (numberOfEntry > QUEUELENGTH - HIGH_PRIORITY_QUEUE_ENTRY) {
-        ENABLE_INTERRUPTS();
-        return FALSE;
-    } else {
-        ENABLE_INTERRUPTS();
-        return TRUE;
-    }
+    ENABLE_INTERRUPTS();
 }
 
+//======= called by IEEE80215E
+
 OpenQueueEntry_t* openqueue_macGetEBPacket() {
    uint8_t i;
    INTERRUPT_DECLARATION();
    DISABLE_INTERRUPTS();
-   for (i=0;i<QUEUELENGTH;i++) {
-      if (openqueue_vars.queue[i].owner==COMPONENT_SIXTOP_TO_IEEE802154E &&
-          openqueue_vars.queue[i].creator==COMPONENT_SIXTOP              &&
+   for (i=openqueue_macTxNext(OPENQUEUE_OTHER_LIST,OPENQUEUE_NO_ENTRY);i<QUEUELENGTH;i=openqueue_macTxNext(OPENQUEUE_OTHER_LIST,i)) {
+      if (openqueue_vars.queue[i].creator==COMPONENT_SIXTOP              &&
           packetfunctions_isBroadcastMulticast(&(openqueue_vars.queue[i].l2_nextORpreviousHop))) {
          ENABLE_INTERRUPTS();
          return &openqueue_vars.queue[i];
@@ -370,11 +535,12 @@ OpenQueueEntry_t* openqueue_macGetEBPacket() {
 
 OpenQueueEntry_t* openqueue_macGetKaPacket(open_addr_t* toNeighbor) {
     uint8_t i;
+    uint8_t list;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-            openqueue_vars.queue[i].creator == COMPONENT_SIXTOP &&
+    list = openqueue_getMacTxList(toNeighbor);
+    for (i = openqueue_macTxNext(list, OPENQUEUE_NO_ENTRY); i < QUEUELENGTH; i = openqueue_macTxNext(list, i)) {
+        if (openqueue_vars.queue[i].creator == COMPONENT_SIXTOP &&
             toNeighbor->type == ADDR_64B &&
             packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
                 ) {
@@ -390,9 +556,8 @@ OpenQueueEntry_t*  openqueue_macGetDIOPacket(){
     uint8_t i;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-            openqueue_vars.queue[i].creator == COMPONENT_ICMPv6RPL &&
+    for (i = openqueue_macTxNext(OPENQUEUE_OTHER_LIST, OPENQUEUE_NO_ENTRY); i < QUEUELENGTH; i = openqueue_macTxNext(OPENQUEUE_OTHER_LIST, i)) {
+        if (openqueue_vars.queue[i].creator == COMPONENT_ICMPv6RPL &&
             packetfunctions_isBroadcastMulticast(&(openqueue_vars.queue[i].l2_nextORpreviousHop))) {
             ENABLE_INTERRUPTS();
             return &openqueue_vars.queue[i];
@@ -428,6 +593,9 @@ void openqueue_updateNextHopPayload(open_addr_t *newNextHop) {
                 for (j = 0; j < 8; j++) {
                     *((uint8_t *) openqueue_vars.queue[i].l2_nextHop_payload + j) = newNextHop->addr_64b[j];
                 }
+                ieee154e_invalidatePreparedFrame(&openqueue_vars.queue[i]);
+                // move the packet to the MAC TX list of its new next hop
+                openqueue_macTxLink(i);
             }
         }
     }
@@ -453,18 +621,21 @@ OpenQueueEntry_t*  openqueue_getPacketByComponent(uint8_t component) {
 
 OpenQueueEntry_t*  openqueue_macGetUnicastPacket(open_addr_t* toNeighbor){
     uint8_t i;
+    uint8_t list;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
+    if (toNeighbor->type != ADDR_64B) {
+        ENABLE_INTERRUPTS();
+        return NULL;
+    }
+    list = openqueue_getMacTxList(toNeighbor);
+
     // first to look the sixtop RES packet
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = openqueue_macTxNext(list, OPENQUEUE_NO_ENTRY); i < QUEUELENGTH; i = openqueue_macTxNext(list, i)) {
         if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
-                (
-                        toNeighbor->type == ADDR_64B &&
-                        packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
-                ) &&
+                packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop) &&
                 openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_RESPONSE
                 ) {
             ENABLE_INTERRUPTS();
@@ -472,34 +643,14 @@ OpenQueueEntry_t*  openqueue_macGetUnicastPacket(open_addr_t* toNeighbor){
         }
     }
 
-    // if reach here, then looking for other unicast packets
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-                (
-                        toNeighbor->type == ADDR_64B &&
-                        packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
-                )
-                ) {
+    // if reach here, then looking for other unicast packets, big packets come last in the list
+    for (i = openqueue_macTxNext(list, OPENQUEUE_NO_ENTRY); i != OPENQUEUE_NO_ENTRY; i = openqueue_macTxNext(list, i)) {
+        if (packetfunctions_sameAddress(toNeighbor, &openqueue_getEntry(i)->l2_nextORpreviousHop)) {
             ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
+            return openqueue_getEntry(i);
         }
     }
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
-        if (
-                ((OpenQueueEntry_t*)&openqueue_vars.big_queue[i])->owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-                (
-                        toNeighbor->type == ADDR_64B &&
-                        packetfunctions_sameAddress(toNeighbor, &((OpenQueueEntry_t*)&openqueue_vars.big_queue[i])->l2_nextORpreviousHop)
-                )
-                ) {
-            ENABLE_INTERRUPTS();
-            return (OpenQueueEntry_t*)&openqueue_vars.big_queue[i];
-        }
-    }
-#endif
     ENABLE_INTERRUPTS();
     return NULL;
 }
@@ -509,6 +660,11 @@ OpenQueueEntry_t*  openqueue_macGetUnicastPacket(open_addr_t* toNeighbor){
 
 void openqueue_reset_entry(OpenQueueEntry_t *entry) {
     //admin
+    if (entry->owner != COMPONENT_NULL) {
+        openqueue_releaseEntry(openqueue_getEntryIndex(entry));
+        // the MAC may have secured this frame ahead of its slot
+        ieee154e_invalidatePreparedFrame(entry);
+    }
     entry->creator = COMPONENT_NULL;
     entry->owner = COMPONENT_NULL;
 
@@ -530,7 +686,10 @@ void openqueue_reset_entry(OpenQueueEntry_t *entry) {
     entry->l3_isFragment = FALSE;
 #endif
     //l2
-    entry->l2_sixtop_command = IANA_6TOP_CMD_NONE;
+    if (entry->l2_sixtop != NULL) {
+        entry->l2_sixtop->isUsed = FALSE;
+        entry->l2_sixtop = NULL;
+    }
     entry->l2_nextORpreviousHop.type = ADDR_NONE;
     entry->l2_frameType = IEEE154_TYPE_UNDEFINED;
     entry->l2_retriesLeft = 0;
@@ -550,3 +709,209 @@ void openqueue_reset_big_entry(OpenQueueBigEntry_t *entry) {
     entry->standard_entry.payload = &(entry->standard_entry.packet[IPV6_PACKET_SIZE]);
 }
 #endif
+
+/**
+\brief Index of a packet buffer, big packet buffers come after the normal ones.
+*/
+uint8_t openqueue_getEntryIndex(OpenQueueEntry_t *entry) {
+#if OPENWSN_6LO_FRAGMENTATION_C
+    if (entry->is_big_packet) {
+        return QUEUELENGTH + (uint8_t) ((OpenQueueBigEntry_t *) entry - &openqueue_vars.big_queue[0]);
+    }
+#endif
+    return (uint8_t) (entry - &openqueue_vars.queue[0]);
+}
+
+OpenQueueEntry_t* openqueue_getEntry(uint8_t index) {
+#if OPENWSN_6LO_FRAGMENTATION_C
+    if (index >= QUEUELENGTH) {
+        return &openqueue_vars.big_queue[index - QUEUELENGTH].standard_entry;
+    }
+#endif
+    return &openqueue_vars.queue[index];
+}
+
+/**
+\brief Select the MAC TX list of a next hop.
+
+Unicast packets are spread over the neighbor lists by the last byte of their
+64-bit next hop, all other packets (EB, DIO, ...) go to OPENQUEUE_OTHER_LIST.
+*/
+uint8_t openqueue_getMacTxList(open_addr_t *nextHop) {
+    if (nextHop->type == ADDR_64B && packetfunctions_isBroadcastMulticast(nextHop) == FALSE) {
+        return nextHop->addr_64b[7] % OPENQUEUE_NUM_NEIGHBOR_LISTS;
+    }
+    return OPENQUEUE_OTHER_LIST;
+}
+
+/**
+\brief (Re)link an entry in the MAC TX list of its next hop.
+
+Lists are kept ordered by index, so the MAC finds the packets in the same order
+as a walk through the queue would.
+*/
+void openqueue_macTxLink(uint8_t index) {
+    uint8_t list;
+    uint8_t *prev;
+
+    openqueue_macTxUnlink(index);
+
+    list = openqueue_getMacTxList(&openqueue_getEntry(index)->l2_nextORpreviousHop);
+    prev = &openqueue_vars.macTxHead[list];
+    while (*prev < index) {
+        prev = &openqueue_vars.macTxNext[*prev];
+    }
+    openqueue_vars.macTxNext[index] = *prev;
+    openqueue_vars.macTxList[index] = list;
+    *prev = index;
+}
+
+void openqueue_macTxUnlink(uint8_t index) {
+    uint8_t *prev;
+
+    if (openqueue_vars.macTxList[index] == OPENQUEUE_NO_ENTRY) {
+        return;
+    }
+    prev = &openqueue_vars.macTxHead[openqueue_vars.macTxList[index]];
+    while (*prev != index) {
+        prev = &openqueue_vars.macTxNext[*prev];
+    }
+    *prev = openqueue_vars.macTxNext[index];
+    openqueue_vars.macTxList[index] = OPENQUEUE_NO_ENTRY;
+}
+
+/**
+\brief Walk a MAC TX list.
+
+Entries which are no longer owned by COMPONENT_SIXTOP_TO_IEEE802154E are
+dropped from the list on the way.
+
+\param list  The MAC TX list to walk.
+\param index The current entry, OPENQUEUE_NO_ENTRY to start from the head.
+
+\returns The index of the next entry waiting for the MAC, OPENQUEUE_NO_ENTRY
+         at the end of the list.
+*/
+uint8_t openqueue_macTxNext(uint8_t list, uint8_t index) {
+    uint8_t *prev;
+    uint8_t next;
+
+    if (index == OPENQUEUE_NO_ENTRY) {
+        prev = &openqueue_vars.macTxHead[list];
+    } else {
+        prev = &openqueue_vars.macTxNext[index];
+    }
+    while (*prev != OPENQUEUE_NO_ENTRY) {
+        next = *prev;
+        if (openqueue_getEntry(next)->owner == COMPONENT_SIXTOP_TO_IEEE802154E) {
+            return next;
+        }
+        *prev = openqueue_vars.macTxNext[next];
+        openqueue_vars.macTxList[next] = OPENQUEUE_NO_ENTRY;
+    }
+    return OPENQUEUE_NO_ENTRY;
+}
+
+/**
+\brief Traffic class of the packets of a creator.
+*/
+uint8_t openqueue_getClass(uint8_t creator) {
+    if (creator <= COMPONENT_SIXTOP_RES) {
+        // EB, KA, 6P, and the frames received by the MAC
+        return OPENQUEUE_CLASS_CONTROL;
+    }
+    switch (creator) {
+        case COMPONENT_ICMPv6RPL:
+            return OPENQUEUE_CLASS_RPL;
+        case COMPONENT_FORWARDING:
+        case COMPONENT_FRAG:
+            return OPENQUEUE_CLASS_FORWARDED;
+        default:
+            return OPENQUEUE_CLASS_LOCAL;
+    }
+}
+
+/**
+\brief Move an entry of the queue to the traffic class of its creator.
+
+Big packet buffers are not counted, they are not subject to quotas.
+*/
+void openqueue_updateClass(uint8_t index, uint8_t creator) {
+    uint8_t trafficClass;
+
+    if (index >= QUEUELENGTH) {
+        return;
+    }
+    if (creator == COMPONENT_NULL) {
+        trafficClass = OPENQUEUE_CLASS_NONE;
+    } else {
+        trafficClass = openqueue_getClass(creator);
+    }
+    if (openqueue_vars.entryClass[index] != OPENQUEUE_CLASS_NONE) {
+        openqueue_vars.numInClass[openqueue_vars.entryClass[index]]--;
+    }
+    if (trafficClass != OPENQUEUE_CLASS_NONE) {
+        openqueue_vars.numInClass[trafficClass]++;
+    }
+    openqueue_vars.entryClass[index] = trafficClass;
+}
+
+/**
+\brief Admission control.
+
+A traffic class may always use its reserved entries. Beyond that, it borrows
+free entries, but only those which are not needed to honor the reservations of
+the other classes. Control traffic has priority and may take any free entry.
+
+\param trafficClass  The traffic class, taken in OPENQUEUE_CLASS_*.
+\param numNewEntries 1 when about to allocate an entry, 0 to check the entries
+                      already held by the class.
+
+\returns TRUE if the class may hold that many entries.
+*/
+bool openqueue_isAdmitted(uint8_t trafficClass, uint8_t numNewEntries) {
+    uint8_t c;
+    uint8_t numInUse;
+    uint8_t numOwed;
+
+    if (trafficClass == OPENQUEUE_CLASS_CONTROL) {
+        return TRUE;
+    }
+    if (openqueue_vars.numInClass[trafficClass] + numNewEntries <= openqueue_reserved[trafficClass]) {
+        return TRUE;
+    }
+
+    numInUse = 0;
+    numOwed = 0;
+    for (c = 0; c < OPENQUEUE_NUM_CLASSES; c++) {
+        numInUse += openqueue_vars.numInClass[c];
+        if (c != trafficClass && openqueue_vars.numInClass[c] < openqueue_reserved[c]) {
+            numOwed += openqueue_reserved[c] - openqueue_vars.numInClass[c];
+        }
+    }
+    return (QUEUELENGTH - numInUse >= numOwed + numNewEntries) ? TRUE : FALSE;
+}
+
+void openqueue_countDrop(uint8_t trafficClass) {
+    if (openqueue_vars.numDrops[trafficClass] < 0xffff) {
+        openqueue_vars.numDrops[trafficClass]++;
+    }
+}
+
+/**
+\brief Put an entry back in its free list.
+*/
+void openqueue_releaseEntry(uint8_t index) {
+    openqueue_macTxUnlink(index);
+    openqueue_updateClass(index, COMPONENT_NULL);
+
+#if OPENWSN_6LO_FRAGMENTATION_C
+    if (index >= QUEUELENGTH) {
+        openqueue_vars.freeNext[index] = openqueue_vars.bigFreeHead;
+        openqueue_vars.bigFreeHead = index;
+        return;
+    }
+#endif
+    openqueue_vars.freeNext[index] = openqueue_vars.freeHead;
+    openqueue_vars.freeHead = index;
+}
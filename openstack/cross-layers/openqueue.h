@@ -15,7 +15,7 @@
 //=========================== define ==========================================
 
 #ifndef PACKETQUEUE_LENGTH
-#define QUEUELENGTH  20
+#define QUEUELENGTH  24
 #else
 #define QUEUELENGTH  PACKETQUEUE_LENGTH
 #endif
@@ -26,6 +26,42 @@
 #define BIGQUEUELENGTH  0
 #endif
 
+// 6P responses: one waiting for the MAC, one being transmitted
+#ifndef SIXTOPCONTEXTLENGTH
+#define SIXTOPCONTEXTLENGTH  2
+#endif
+
+// packets handed to the MAC are indexed in lists: unicast ones by the last byte of their next hop, the others in a
+// single list
+#define OPENQUEUE_NUM_NEIGHBOR_LISTS    8
+#define OPENQUEUE_OTHER_LIST            OPENQUEUE_NUM_NEIGHBOR_LISTS
+#define OPENQUEUE_NUM_MACTX_LISTS       (OPENQUEUE_NUM_NEIGHBOR_LISTS + 1)
+#define OPENQUEUE_NO_ENTRY              0xff
+
+#if QUEUELENGTH + BIGQUEUELENGTH >= OPENQUEUE_NO_ENTRY
+#error "openqueue entries are indexed on 8 bits, QUEUELENGTH + BIGQUEUELENGTH must be smaller than 255."
+#endif
+
+// traffic classes, each one has OPENQUEUE_RESERVED_* entries of the queue (see config.h)
+enum {
+    OPENQUEUE_CLASS_CONTROL = 0,                         // EB, KA, 6P, frames received by the MAC
+    OPENQUEUE_CLASS_RPL = 1,                             // DIO, DAO
+    OPENQUEUE_CLASS_FORWARDED = 2,                       // relayed packets and fragments
+    OPENQUEUE_CLASS_LOCAL = 3,                           // packets originated by this mote
+    OPENQUEUE_NUM_CLASSES = 4,
+    OPENQUEUE_CLASS_NONE = 0xff,
+};
+
+#define OPENQUEUE_RESERVED_TOTAL        (OPENQUEUE_RESERVED_CONTROL + OPENQUEUE_RESERVED_RPL + \
+                                         OPENQUEUE_RESERVED_FORWARDED + OPENQUEUE_RESERVED_LOCAL)
+
+// a queue shorter than the reservations scales them down in proportion, rounding down so that they fit
+#if OPENQUEUE_RESERVED_TOTAL > QUEUELENGTH
+#define OPENQUEUE_RESERVED(n)           ((n) * QUEUELENGTH / OPENQUEUE_RESERVED_TOTAL)
+#else
+#define OPENQUEUE_RESERVED(n)           (n)
+#endif
+
 //=========================== typedef =========================================
 
 typedef struct {
@@ -33,6 +69,15 @@ typedef struct {
     uint8_t owner;
 } debugOpenQueueEntry_t;
 
+#if OPENQUEUE_DEBUG_ENABLE
+BEGIN_PACK
+typedef struct {
+    uint8_t numInClass[OPENQUEUE_NUM_CLASSES];           // entries of the queue in use, per traffic class
+    uint16_t numDrops[OPENQUEUE_NUM_CLASSES];            // packets refused, per traffic class
+} debugOpenQueueClasses_t;
+END_PACK
+#endif
+
 //=========================== module variables ================================
 
 typedef struct {
@@ -40,6 +85,18 @@ typedef struct {
 #if OPENWSN_6LO_FRAGMENTATION_C
     OpenQueueBigEntry_t big_queue[BIGQUEUELENGTH];
 #endif
+    uint8_t macTxHead[OPENQUEUE_NUM_MACTX_LISTS];        // first entry of each MAC TX list
+    uint8_t macTxNext[QUEUELENGTH + BIGQUEUELENGTH];     // next entry in the same MAC TX list, by increasing index
+    uint8_t macTxList[QUEUELENGTH + BIGQUEUELENGTH];     // MAC TX list the entry is linked in, OPENQUEUE_NO_ENTRY if none
+    uint8_t freeHead;                                    // last freed entry of queue, OPENQUEUE_NO_ENTRY if full
+#if OPENWSN_6LO_FRAGMENTATION_C
+    uint8_t bigFreeHead;                                 // last freed entry of big_queue, OPENQUEUE_NO_ENTRY if full
+#endif
+    uint8_t freeNext[QUEUELENGTH + BIGQUEUELENGTH];      // next entry in the same free list
+    uint8_t entryClass[QUEUELENGTH];                     // traffic class the entry is counted in, OPENQUEUE_CLASS_NONE if free
+    uint8_t numInClass[OPENQUEUE_NUM_CLASSES];           // entries of queue in use, per traffic class
+    uint16_t numDrops[OPENQUEUE_NUM_CLASSES];            // packets refused, per traffic class
+    OpenQueueSixtopContext_t sixtopContext[SIXTOPCONTEXTLENGTH];
 } openqueue_vars_t;
 
 //=========================== prototypes ======================================
@@ -49,6 +106,10 @@ void openqueue_init(void);
 
 bool debugPrint_queue(void);
 
+#if OPENQUEUE_DEBUG_ENABLE
+bool debugPrint_queueClasses(void);
+#endif
+
 // called by any component
 OpenQueueEntry_t* openqueue_getFreePacketBuffer(uint8_t creator);
 
@@ -60,7 +121,11 @@ owerror_t openqueue_freePacketBuffer(OpenQueueEntry_t *pkt);
 
 void openqueue_removeAllCreatedBy(uint8_t creator);
 
-bool openqueue_isHighPriorityEntryEnough(void);
+void openqueue_setCreator(OpenQueueEntry_t *pkt, uint8_t creator);
+
+owerror_t openqueue_attachSixtopContext(OpenQueueEntry_t *pkt);
+
+bool openqueue_isWithinQuota(OpenQueueEntry_t *pkt);
 
 // called by ICMPv6
 void openqueue_updateNextHopPayload(open_addr_t *newNextHop);
@@ -76,6 +141,8 @@ uint8_t openqueue_getNum6PReq(open_addr_t *neighbor);
 
 void openqueue_remove6PrequestToNeighbor(open_addr_t *neighbor);
 
+void openqueue_macPutPacket(OpenQueueEntry_t *pkt);
+
 // called by IEEE80215E
 OpenQueueEntry_t* openqueue_macGetEBPacket(void);
 
@@ -0,0 +1,141 @@
+#include "opendefs.h"
+#include "trickle.h"
+#include "openrandom.h"
+
+//=========================== variables =======================================
+
+//=========================== prototypes ======================================
+
+void trickle_startInterval(trickle_t *trickle);
+
+//=========================== public ==========================================
+
+/**
+\brief Bind a Trickle timer to the timer which drives it.
+
+\param[in] trickle  The Trickle timer.
+\param[in] timerId  The timer to use, created by the caller.
+\param[in] callback The callback of that timer, which calls trickle_timerFired().
+*/
+void trickle_init(trickle_t *trickle, opentimers_id_t timerId, opentimers_cbt callback) {
+    memset(trickle, 0, sizeof(trickle_t));
+    trickle->timerId = timerId;
+    trickle->callback = callback;
+    trickle->phase = TRICKLE_STOPPED;
+}
+
+/**
+\brief Start the Trickle timer with its first interval of size Imin.
+
+\param[in] trickle      The Trickle timer.
+\param[in] Imin         The minimum interval size, in ms.
+\param[in] numDoublings How many times Imin may double, giving Imax.
+\param[in] k            The redundancy constant, TRICKLE_REDUNDANCY_INFINITE to never suppress.
+*/
+void trickle_start(trickle_t *trickle, uint32_t Imin, uint8_t numDoublings, uint8_t k) {
+    uint8_t i;
+
+    if (Imin == 0) {
+        Imin = 1;
+    }
+    trickle->Imin = Imin;
+    trickle->Imax = Imin;
+    for (i = 0; i < numDoublings; i++) {
+        if (trickle->Imax > (0xffffffff / PORT_TICS_PER_MS) / 2) {
+            // the timer would not be able to count a longer interval
+            break;
+        }
+        trickle->Imax <<= 1;
+    }
+    trickle->k = k;
+    trickle->I = Imin;
+
+    trickle_startInterval(trickle);
+}
+
+void trickle_stop(trickle_t *trickle) {
+    opentimers_cancel(trickle->timerId);
+    trickle->phase = TRICKLE_STOPPED;
+}
+
+/**
+\brief Indicate a consistent transmission was heard in the current interval.
+*/
+void trickle_consistent(trickle_t *trickle) {
+    if (trickle->c < 0xff) {
+        trickle->c++;
+    }
+}
+
+/**
+\brief Indicate an inconsistency was detected, shrinking the interval to Imin.
+
+Nothing changes if the interval is already Imin.
+*/
+void trickle_inconsistent(trickle_t *trickle) {
+    if (trickle->phase == TRICKLE_STOPPED || trickle->I == trickle->Imin) {
+        return;
+    }
+    trickle->I = trickle->Imin;
+    trickle_startInterval(trickle);
+}
+
+/**
+\brief Advance the Trickle timer, called when its timer fires.
+
+\returns TRUE when it is time to transmit, i.e. time t of the interval was
+    reached and fewer than k consistent transmissions were heard.
+*/
+bool trickle_timerFired(trickle_t *trickle) {
+    switch (trickle->phase) {
+        case TRICKLE_WAIT_T:
+            trickle->phase = TRICKLE_WAIT_END;
+            opentimers_scheduleIn(
+                    trickle->timerId,
+                    trickle->I - trickle->t,
+                    TIME_MS,
+                    TIMER_ONESHOT,
+                    trickle->callback
+            );
+            return (trickle->k == TRICKLE_REDUNDANCY_INFINITE || trickle->c < trickle->k);
+        case TRICKLE_WAIT_END:
+            // the interval expired, double it up to Imax
+            if (trickle->I <= trickle->Imax / 2) {
+                trickle->I <<= 1;
+            } else {
+                trickle->I = trickle->Imax;
+            }
+            trickle_startInterval(trickle);
+            return FALSE;
+        default:
+            return FALSE;
+    }
+}
+
+//=========================== private =========================================
+
+/**
+\brief Reset the counter and schedule time t, picked in [I/2, I).
+*/
+void trickle_startInterval(trickle_t *trickle) {
+    uint32_t half;
+    uint16_t random;
+
+    half = trickle->I / 2;
+    random = openrandom_get16b();
+    // (half * random) >> 16, split so it does not overflow 32 bits
+    trickle->t = half + (half >> 16) * random + (((half & 0xffff) * random) >> 16);
+    if (trickle->t == 0) {
+        trickle->t = 1;
+    }
+    trickle->c = 0;
+    trickle->phase = TRICKLE_WAIT_T;
+
+    opentimers_scheduleIn(
+            trickle->timerId,
+            trickle->t,
+            TIME_MS,
+            TIMER_ONESHOT,
+            trickle->callback
+    );
+}
@@ -0,0 +1,65 @@
+#ifndef OPENWSN_TRICKLE_H
+#define OPENWSN_TRICKLE_H
+
+/**
+\addtogroup cross-layers
+\{
+\addtogroup Trickle
+\{
+*/
+
+#include "opendefs.h"
+#include "opentimers.h"
+
+//=========================== define ==========================================
+
+#define TRICKLE_REDUNDANCY_INFINITE 0 // a redundancy constant of 0 never suppresses a transmission
+
+typedef enum {
+    TRICKLE_STOPPED = 0,             // no interval running
+    TRICKLE_WAIT_T = 1,              // waiting for time t, the transmission point of the interval
+    TRICKLE_WAIT_END = 2,            // waiting for the end of the interval
+} trickle_phase_t;
+
+//=========================== typedef =========================================
+
+/**
+\brief State of one Trickle timer, per RFC 6206.
+
+The user creates the timer and passes its callback, which runs in task mode and
+calls trickle_timerFired() to learn whether to transmit.
+*/
+typedef struct {
+    uint32_t Imin;                   // minimum interval size, in ms
+    uint32_t Imax;                   // maximum interval size, in ms (Imin doubled numDoublings times)
+    uint32_t I;                      // current interval size, in ms
+    uint32_t t;                      // transmission point in the current interval, in ms
+    uint8_t k;                       // redundancy constant
+    uint8_t c;                       // consistent transmissions heard in the current interval
+    trickle_phase_t phase;           // where we are in the current interval
+    opentimers_id_t timerId;         // timer driving the intervals
+    opentimers_cbt callback;         // callback of that timer
+} trickle_t;
+
+//=========================== module variables ================================
+
+//=========================== prototypes ======================================
+
+void trickle_init(trickle_t *trickle, opentimers_id_t timerId, opentimers_cbt callback);
+
+void trickle_start(trickle_t *trickle, uint32_t Imin, uint8_t numDoublings, uint8_t k);
+
+void trickle_stop(trickle_t *trickle);
+
+void trickle_consistent(trickle_t *trickle);
+
+void trickle_inconsistent(trickle_t *trickle);
+
+bool trickle_timerFired(trickle_t *trickle);
+
+/**
+\}
+\}
+*/
+
+#endif /* OPENWSN_TRICKLE_H */
@@ -33,6 +33,7 @@
 #include "icmpv6.h"
 #include "icmpv6echo.h"
 #include "icmpv6rpl.h"
+#include "routingtable.h"
 //-- 04-TRAN
 #if OPENWSN_UDP_C
 #include "sock.h"
@@ -86,6 +87,7 @@ void openstack_init(void) {
 
     //-- 03b-IPv6
     forwarding_init();
+    routingtable_init();
     icmpv6_init();
 
 #if OPENWSN_ICMPV6_ECHO_C
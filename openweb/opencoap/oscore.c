@@ -82,6 +82,7 @@ void oscore_init_security_context(oscore_security_context_t *ctx,
                                   uint8_t masterSecretLen,
                                   uint8_t *masterSalt,
                                   uint8_t masterSaltLen) {
+    uint8_t key[AES_CCM_16_64_128_KEY_LEN];
 
     if (senderIDLen > OSCOAP_MAX_ID_LEN || recipientIDLen > OSCOAP_MAX_ID_LEN) {
         return;
@@ -112,7 +113,7 @@ void oscore_init_security_context(oscore_security_context_t *ctx,
     memcpy(ctx->senderID, senderID, senderIDLen);
     ctx->senderIDLen = senderIDLen;
     // invoke HKDF to get sender Key
-    hkdf_derive_parameter(ctx->senderKey,
+    hkdf_derive_parameter(key,
                           masterSecret,
                           masterSecretLen,
                           masterSalt,
@@ -124,13 +125,15 @@ void oscore_init_security_context(oscore_security_context_t *ctx,
                           AES_CCM_16_64_128,
                           OSCOAP_DERIVATION_TYPE_KEY,
                           AES_CCM_16_64_128_KEY_LEN);
+    // expand it once for all messages
+    aes128_key_init(&ctx->senderKey, key);
     ctx->sequenceNumber = 0;
 
     // recipient context
     memcpy(ctx->recipientID, recipientID, recipientIDLen);
     ctx->recipientIDLen = recipientIDLen;
     // invoke HKDF to get recipient Key
-    hkdf_derive_parameter(ctx->recipientKey,
+    hkdf_derive_parameter(key,
                           masterSecret,
                           masterSecretLen,
                           masterSalt,
@@ -142,6 +145,7 @@ void oscore_init_security_context(oscore_security_context_t *ctx,
                           AES_CCM_16_64_128,
                           OSCOAP_DERIVATION_TYPE_KEY,
                           AES_CCM_16_64_128_KEY_LEN);
+    aes128_key_init(&ctx->recipientKey, key);
 
     ctx->window.bitArray = 0x01; // LSB set
     ctx->window.rightEdge = 0;
@@ -272,7 +276,7 @@ owerror_t oscore_protect_message(
                                 &payloadLen,
                                 nonce,
                                 2, // L=2 in 15.4 std
-                                context->senderKey,
+                                &context->senderKey,
                                 AES_CCM_16_64_128_TAG_LEN);
 
     if (encStatus != E_SUCCESS) {
@@ -379,7 +383,7 @@ owerror_t oscore_unprotect_message(
                                 &ciphertextLen,
                                 nonce,
                                 2,
-                                context->recipientKey,
+                                &context->recipientKey,
                                 AES_CCM_16_64_128_TAG_LEN);
 
     if (decStatus != E_SUCCESS) {
@@ -38,11 +38,11 @@ typedef struct
     uint8_t len_tag;
     uint8_t nonce[13];
     uint8_t a[15];
-    uint8_t m[20 + 4];
+    uint8_t m[20 + 16];
     uint8_t len_a;
     uint8_t len_m;
     uint8_t l;
-    uint8_t expected_ciphertext[24];
+    uint8_t expected_ciphertext[20 + 16];
 } aes_ccms_enc_suite_t;
 
 typedef struct
@@ -51,7 +51,7 @@ typedef struct
     uint8_t len_tag;
     uint8_t nonce[13];
     uint8_t a[15];
-    uint8_t c[20 + 4];
+    uint8_t c[20 + 16];
     uint8_t len_a;
     uint8_t len_c;
     uint8_t l;
@@ -263,6 +263,20 @@ int mote_main(void) {
          { 0x92, 0xe8, 0xad, 0xca, 0x53, 0x81, 0xbf, 0xd0, 0x5b, 0xdd, 0xf3, 0x61, 0x09, 0x09, 0x82, 0xe6, 0x2c,
             0x61, 0x01, 0x4e, 0x7b, 0x34, 0x4f, 0x09 } /* expected ciphertext */
       },
+      { /* 16-octet tag, B0 flags encode M as (M-2)/2 */
+         { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, /* key */
+            16, /* tag_len */
+         { 0x00, 0x00, 0xf0, 0xe0, 0xd0, 0xc0, 0xb0, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x05 }, /* nonce */
+         { 0x69, 0x98, 0x03, 0x33, 0x63, 0xbb, 0xaa, 0x01, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x03}, /* a vector */
+         { 0x14, 0xaa, 0xbb, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+            0x0c, 0x0d, 0x0e, 0x0f }, /* m vector + 16 octets for authentication tag */
+         15, /* len_a */
+         20, /* len_m */
+         2, /* CCM L */
+         { 0x92, 0xe8, 0xad, 0xca, 0x53, 0x81, 0xbf, 0xd0, 0x5b, 0xdd, 0xf3, 0x61, 0x09, 0x09, 0x82, 0xe6, 0x2c,
+            0x61, 0x01, 0x4e, 0xf3, 0xd9, 0x1c, 0xbd, 0x64, 0x00, 0x28, 0x11, 0x86, 0x78, 0x0d, 0x55, 0xe1,
+            0xdb, 0x5b, 0xbf } /* expected ciphertext */
+      },
    };
 #endif /* TEST_AES_CCMS_ENC */
 
@@ -295,6 +309,20 @@ int mote_main(void) {
         { 0x14, 0xaa, 0xbb, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
             0x0c, 0x0d, 0x0e, 0x0f } /* expected plaintext */
       },
+      { /* 16-octet tag, B0 flags encode M as (M-2)/2 */
+        { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, /* key */
+        16, /* tag len */
+        { 0x00, 0x00, 0xf0, 0xe0, 0xd0, 0xc0, 0xb0, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x05 }, /* nonce */
+        { 0x69, 0x98, 0x03, 0x33, 0x63, 0xbb, 0xaa, 0x01, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x03 }, /* a vector */
+        { 0x92, 0xe8, 0xad, 0xca, 0x53, 0x81, 0xbf, 0xd0, 0x5b, 0xdd, 0xf3, 0x61, 0x09, 0x09, 0x82, 0xe6, 0x2c,
+            0x61, 0x01, 0x4e, 0xf3, 0xd9, 0x1c, 0xbd, 0x64, 0x00, 0x28, 0x11, 0x86, 0x78, 0x0d, 0x55, 0xe1,
+            0xdb, 0x5b, 0xbf }, /* c vector (m + tag) */
+        15, /* len_a */
+        36, /* len_c */
+        2, /* CCM L */
+        { 0x14, 0xaa, 0xbb, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+            0x0c, 0x0d, 0x0e, 0x0f } /* expected plaintext */
+      },
    };
 #endif /* TEST_AES_CCMS_DEC */
 
@@ -59,7 +59,7 @@ int mote_main(void) {
     scheduler_init();
     opentimers_init();
 
-    app_vars.timer0_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE);
+    app_vars.timer0_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE, COMPONENT_OPENWSN);
     opentimers_scheduleAbsolute    (
         app_vars.timer0_id,             // id
         TIMER0_PERIOD_MS,               // duration
@@ -68,7 +68,7 @@ int mote_main(void) {
         timer0_cb                       // callback
     );
 
-    app_vars.timer1_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE);
+    app_vars.timer1_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE, COMPONENT_OPENWSN);
     opentimers_scheduleIn    (
         app_vars.timer1_id,    // id
         TIMER1_PERIOD_MS,      // duration
@@ -77,7 +77,7 @@ int mote_main(void) {
         timer1_cb              // callback
     );
 
-    app_vars.timer2_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE);
+    app_vars.timer2_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE, COMPONENT_OPENWSN);
     opentimers_scheduleIn    (
         app_vars.timer2_id,    // id
         TIMER2_PERIOD_MS,      // duration
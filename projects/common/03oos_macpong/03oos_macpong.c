@@ -105,7 +105,7 @@ void macpong_send(uint8_t payloadCtr) {
 //===== IPHC
 
 void iphc_init(void) {
-    macpong_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_IPHC);
+    macpong_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_IPHC, COMPONENT_OPENWSN);
     opentimers_scheduleIn(
             macpong_vars.timerId,   // timerId
             1000,                   // duration
@@ -203,6 +203,12 @@ void icmpv6rpl_setMyDAGrank(dagrank_t rank) { return; }
 
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void) { return; }
 
+void icmpv6rpl_indicateNeighborUpdate(uint8_t neighborIndex) { return; }
+
+void icmpv6rpl_updateCandidateParent(uint8_t neighborIndex) { return; }
+
+void routingtable_removeNextHop(uint8_t nextHop) { return; }
+
 void icmpv6echo_setIsReplyEnabled(bool isEnabled) { return; }
 
 
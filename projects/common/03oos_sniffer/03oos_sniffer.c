@@ -86,7 +86,7 @@ int mote_main(void) {
     radio_setEndFrameCb(cb_endFrame);
 
     // start timer
-    app_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SNIFFER);
+    app_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SNIFFER, COMPONENT_OPENWSN);
     reference = opentimers_getValue();
     opentimers_scheduleAbsolute(
             app_vars.timerId,      // timerId
@@ -228,6 +228,12 @@ void icmpv6rpl_writeDODAGid(uint8_t *dodagid) { return; }
 
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void) { return; }
 
+void icmpv6rpl_indicateNeighborUpdate(uint8_t neighborIndex) { return; }
+
+void icmpv6rpl_updateCandidateParent(uint8_t neighborIndex) { return; }
+
+void routingtable_removeNextHop(uint8_t nextHop) { return; }
+
 bool icmpv6rpl_getPreferredParentEui64(open_addr_t *neighbor) { return TRUE; }
 
 void icmpv6echo_setIsReplyEnabled(bool isEnabled) { return; }
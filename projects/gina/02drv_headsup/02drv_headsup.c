@@ -79,7 +79,7 @@ int mote_main(void) {
    uart_enableInterrupts();           // Enable USCI_A1 TX & RX interrupt
    
    // start the timer   
-    app_vars.timer_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE);
+    app_vars.timer_id = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE, COMPONENT_OPENWSN);
     opentimers_scheduleIn(
         app_vars.timer_id,
         APP_DLY_TIMER_ms,